@@ -0,0 +1,196 @@
+/*
+ * AsyncHTTP - host build shim
+ *
+ * Just enough of the Arduino core (String, Print, Stream, timing) to compile
+ * the library on a PC for the fuzz targets and benchmarks in this folder.
+ * Time is virtual: millis() returns hostMillis, which the harness advances.
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#ifndef ASYNC_HTTP_HOST_ARDUINO_H
+#define ASYNC_HTTP_HOST_ARDUINO_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <strings.h>
+
+typedef uint8_t byte;
+
+// ---------------------------------------------------------------------------
+// Flash strings, timing and helpers
+// ---------------------------------------------------------------------------
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+extern unsigned long hostMillis;
+inline unsigned long millis() { return hostMillis; }
+inline unsigned long micros() { return hostMillis * 1000UL; }
+inline void delay(unsigned long ms) { hostMillis += ms; }
+inline void yield() {}
+inline long random(long max) { return max > 0 ? rand() % max : 0; }
+inline long random(long min, long max) {
+  return max > min ? min + rand() % (max - min) : min;
+}
+
+using std::max;
+using std::min;
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+
+#define PROGMEM
+inline size_t strlen_P(const char* s) { return strlen(s); }
+inline void*  memcpy_P(void* d, const void* s, size_t n) { return memcpy(d, s, n); }
+
+// ---------------------------------------------------------------------------
+// String
+// ---------------------------------------------------------------------------
+class String {
+public:
+  String() {}
+  String(const char* c) { if (c) _s = c; }
+  String(const __FlashStringHelper* c) { if (c) _s = (const char*)c; }
+  String(char c) : _s(1, c) {}
+  String(int v) : _s(std::to_string(v)) {}
+  String(unsigned v) : _s(std::to_string(v)) {}
+  String(long v) : _s(std::to_string(v)) {}
+  String(unsigned long v) : _s(std::to_string(v)) {}
+  String(unsigned long v, int base) {
+    char b[24];
+    snprintf(b, sizeof(b), base == 16 ? "%lx" : "%lu", v);
+    _s = b;
+  }
+  String(unsigned v, int base) : String((unsigned long)v, base) {}
+  String(int v, int base) : String((unsigned long)(unsigned)v, base) {}
+
+  unsigned    length() const { return (unsigned)_s.size(); }
+  const char* c_str() const { return _s.c_str(); }
+  bool        reserve(unsigned n) { _s.reserve(n); return true; }
+
+  bool concat(const char* p, unsigned n) { _s.append(p, n); return true; }
+  bool concat(const String& o) { _s += o._s; return true; }
+  bool concat(char c) { _s += c; return true; }
+
+  String& operator+=(const String& o) { _s += o._s; return *this; }
+  String& operator+=(const char* o) { if (o) _s += o; return *this; }
+  String& operator+=(const __FlashStringHelper* o) {
+    _s += (const char*)o;
+    return *this;
+  }
+  String& operator+=(char c) { _s += c; return *this; }
+  String& operator+=(int v) { _s += std::to_string(v); return *this; }
+  String& operator+=(unsigned v) { _s += std::to_string(v); return *this; }
+  String& operator+=(long v) { _s += std::to_string(v); return *this; }
+  String& operator+=(unsigned long v) { _s += std::to_string(v); return *this; }
+
+  friend String operator+(const String& a, const String& b) {
+    String r(a); r += b; return r;
+  }
+  friend String operator+(const String& a, const char* b) {
+    String r(a); r += b; return r;
+  }
+  friend String operator+(const char* a, const String& b) {
+    String r(a); r += b; return r;
+  }
+  friend String operator+(const String& a, char b) {
+    String r(a); r += b; return r;
+  }
+
+  bool operator==(const String& o) const { return _s == o._s; }
+  bool operator==(const char* o) const { return _s == o; }
+  bool operator!=(const String& o) const { return _s != o._s; }
+  bool operator!=(const char* o) const { return _s != o; }
+  char  operator[](unsigned i) const { return i < _s.size() ? _s[i] : 0; }
+  char& operator[](unsigned i) { return _s[i]; }
+  char  charAt(unsigned i) const { return (*this)[i]; }
+  void  setCharAt(unsigned i, char c) { if (i < _s.size()) _s[i] = c; }
+
+  bool equals(const String& o) const { return _s == o._s; }
+  bool equalsIgnoreCase(const String& o) const {
+    return _s.size() == o._s.size() &&
+           strncasecmp(_s.c_str(), o._s.c_str(), _s.size()) == 0;
+  }
+  bool startsWith(const String& p) const {
+    return _s.size() >= p._s.size() && _s.compare(0, p._s.size(), p._s) == 0;
+  }
+  bool endsWith(const String& p) const {
+    return _s.size() >= p._s.size() &&
+           _s.compare(_s.size() - p._s.size(), p._s.size(), p._s) == 0;
+  }
+  int indexOf(char c, unsigned from = 0) const { return _pos(_s.find(c, from)); }
+  int indexOf(const String& c, unsigned from = 0) const {
+    return _pos(_s.find(c._s, from));
+  }
+  int lastIndexOf(char c) const { return _pos(_s.rfind(c)); }
+
+  String substring(unsigned a) const {
+    return a >= _s.size() ? String() : String(_s.substr(a).c_str());
+  }
+  String substring(unsigned a, unsigned b) const {
+    if (a > b) std::swap(a, b);
+    return a >= _s.size() ? String() : String(_s.substr(a, b - a).c_str());
+  }
+  long toInt() const { return atol(_s.c_str()); }
+  void trim() {
+    size_t a = 0, b = _s.size();
+    while (a < b && isspace((unsigned char)_s[a])) a++;
+    while (b > a && isspace((unsigned char)_s[b - 1])) b--;
+    _s = _s.substr(a, b - a);
+  }
+  void remove(unsigned i) { if (i < _s.size()) _s.erase(i); }
+  void remove(unsigned i, unsigned n) { if (i < _s.size()) _s.erase(i, n); }
+  void toLowerCase() { for (char& c : _s) c = (char)tolower((unsigned char)c); }
+  void toUpperCase() { for (char& c : _s) c = (char)toupper((unsigned char)c); }
+  void replace(const String& a, const String& b) {
+    if (a._s.empty()) return;
+    for (size_t p = 0; (p = _s.find(a._s, p)) != std::string::npos;
+         p += b._s.size()) {
+      _s.replace(p, a._s.size(), b._s);
+    }
+  }
+
+private:
+  static int _pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+  std::string _s;
+};
+
+// ---------------------------------------------------------------------------
+// Print / Stream
+// ---------------------------------------------------------------------------
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* b, size_t n) {
+    size_t k = 0;
+    while (n--) k += write(*b++);
+    return k;
+  }
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  size_t write(const char* s, size_t n) { return write((const uint8_t*)s, n); }
+  size_t print(const String& s) { return write(s.c_str(), s.length()); }
+  size_t print(const char* s) { return write(s); }
+  size_t print(const __FlashStringHelper* s) { return write((const char*)s); }
+  virtual void flush() {}
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual size_t readBytes(char* b, size_t n) {
+    size_t k = 0;
+    int    c;
+    while (k < n && (c = read()) >= 0) b[k++] = (char)c;
+    return k;
+  }
+  size_t readBytes(uint8_t* b, size_t n) { return readBytes((char*)b, n); }
+};
+
+#endif // ASYNC_HTTP_HOST_ARDUINO_H
@@ -0,0 +1,99 @@
+/*
+ * AsyncHTTP - host build shim
+ *
+ * Arduino's Client interface, plus a scripted WiFiClient standing in for the
+ * network: every connect() replays hostNet.response, handing out at most
+ * hostNet.budget bytes until the harness refills it (one "packet" per
+ * update()). Bytes written by the library are collected in hostNet.sent.
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#ifndef ASYNC_HTTP_HOST_CLIENT_H
+#define ASYNC_HTTP_HOST_CLIENT_H
+
+#include "Arduino.h"
+
+class IPAddress {
+public:
+  uint8_t b[4] = { 0, 0, 0, 0 };
+};
+
+class Client : public Stream {
+public:
+  virtual int     connect(IPAddress ip, uint16_t port) = 0;
+  virtual int     connect(const char* host, uint16_t port) = 0;
+  virtual size_t  write(uint8_t c) = 0;
+  virtual size_t  write(const uint8_t* buf, size_t size) = 0;
+  virtual int     available() = 0;
+  virtual int     read() = 0;
+  virtual int     read(uint8_t* buf, size_t size) = 0;
+  virtual int     peek() = 0;
+  virtual void    flush() = 0;
+  virtual void    stop() = 0;
+  virtual uint8_t connected() = 0;
+  virtual operator bool() = 0;
+  using Print::write;
+};
+
+// ---------------------------------------------------------------------------
+// Scripted network shared by every WiFiClient
+// ---------------------------------------------------------------------------
+struct HostNet {
+  std::string response;             // what the server sends per connection
+  size_t      budget     = 0;       // bytes readable until the next refill
+  bool        closeAfter = true;    // server closes once it has sent all
+  bool        refuse     = false;   // connect() fails
+  uint32_t    connects   = 0;
+  std::string sent;                 // everything the library wrote
+};
+extern HostNet hostNet;
+
+class WiFiClient : public Client {
+public:
+  int connect(IPAddress, uint16_t) override { return 0; }
+  int connect(const char*, uint16_t) override {
+    if (hostNet.refuse) return 0;
+    hostNet.connects++;
+    _open = true;
+    _in   = hostNet.response;
+    _pos  = 0;
+    return 1;
+  }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* b, size_t n) override {
+    if (!_open) return 0;
+    hostNet.sent.append((const char*)b, n);
+    return n;
+  }
+  int available() override {
+    if (!_open) return 0;
+    return (int)std::min(_in.size() - _pos, hostNet.budget);
+  }
+  int read() override {
+    if (available() <= 0) return -1;
+    hostNet.budget--;
+    return (uint8_t)_in[_pos++];
+  }
+  int read(uint8_t* b, size_t n) override {
+    size_t k = 0;
+    int    c;
+    while (k < n && (c = read()) >= 0) b[k++] = (uint8_t)c;
+    return k ? (int)k : -1;
+  }
+  int peek() override { return available() > 0 ? (uint8_t)_in[_pos] : -1; }
+  void flush() override {}
+  void stop() override { _open = false; }
+  uint8_t connected() override {
+    return _open && !(hostNet.closeAfter && _pos == _in.size());
+  }
+  operator bool() override { return _open; }
+
+private:
+  bool        _open = false;
+  std::string _in;
+  size_t      _pos  = 0;
+};
+
+#endif // ASYNC_HTTP_HOST_CLIENT_H
@@ -0,0 +1,113 @@
+/*
+ * AsyncHTTP - micro-benchmark of URL parsing
+ *
+ * Compares AsyncHTTPUrl::parse with the substring-based parser it replaced
+ * (kept below as legacyParse), reporting time and heap allocations per URL.
+ * Host numbers only show the relative cost; on a microcontroller every
+ * allocation also fragments the heap.
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#include <AsyncHTTP.h>
+#include <chrono>
+#include <new>
+
+// ---------------------------------------------------------------------------
+// Allocation counter
+// ---------------------------------------------------------------------------
+static unsigned long allocations = 0;
+
+void* operator new(size_t n) {
+  allocations++;
+  void* p = malloc(n ? n : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// ---------------------------------------------------------------------------
+// The previous AsyncHTTP::_parseUrl
+// ---------------------------------------------------------------------------
+static bool legacyParse(const String& url, String& host, uint16_t& port,
+                        String& path, bool& tls) {
+  String u = url;
+  tls = false;
+
+  if (u.startsWith("https://")) {
+    tls = true;
+    u = u.substring(8);
+  } else if (u.startsWith("http://")) {
+    u = u.substring(7);
+  } else {
+    return false;
+  }
+
+  int slashIdx = u.indexOf('/');
+  String hostPort;
+  if (slashIdx < 0) {
+    hostPort = u;
+    path = "/";
+  } else {
+    hostPort = u.substring(0, slashIdx);
+    path = u.substring(slashIdx);
+  }
+
+  int colonIdx = hostPort.indexOf(':');
+  if (colonIdx > 0) {
+    host = hostPort.substring(0, colonIdx);
+    port = (uint16_t)hostPort.substring(colonIdx + 1).toInt();
+  } else {
+    host = hostPort;
+    port = tls ? 443 : 80;
+  }
+  return host.length() > 0;
+}
+
+// ---------------------------------------------------------------------------
+
+static const char* const kUrls[] = {
+  "http://example.com",
+  "https://api.example.com/v1/devices/42/telemetry",
+  "http://192.168.1.20:8080/status?verbose=1&fields=temp,humidity",
+  "https://iot.example-cloud.com:8443/ingest/very/long/path/segment?"
+  "token=abcdef0123456789abcdef0123456789&ts=1700000000",
+};
+static const size_t kCount = sizeof(kUrls) / sizeof(kUrls[0]);
+
+template <typename F>
+static void run(const char* name, unsigned long iterations, F parse) {
+  unsigned long before = allocations;
+  auto start = std::chrono::steady_clock::now();
+  unsigned long ok = 0;
+  for (unsigned long i = 0; i < iterations; i++) {
+    ok += parse(i % kCount);
+  }
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+  printf("%-22s %8.1f ns/url  %5.2f allocations/url  (%lu parsed)\n", name,
+         (double)ns / iterations,
+         (double)(allocations - before) / iterations, ok);
+}
+
+int main(int argc, char** argv) {
+  unsigned long iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+
+  // Inputs are built up front so only the parsing is measured
+  String urls[kCount];
+  for (size_t i = 0; i < kCount; i++) urls[i] = kUrls[i];
+
+  run("AsyncHTTPUrl::parse", iterations, [&](size_t i) {
+    AsyncHTTPUrl u;
+    return (unsigned long)u.parse(urls[i].c_str());
+  });
+  run("legacy substring parse", iterations, [&](size_t i) {
+    String   host, path;
+    uint16_t port;
+    bool     tls;
+    return (unsigned long)legacyParse(urls[i], host, port, path, tls);
+  });
+  return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * AsyncHTTP - stand-alone driver for the fuzz targets
+ *
+ * Used when the compiler has no libFuzzer (-fsanitize=fuzzer). Loads the
+ * seed files given on the command line, then feeds LLVMFuzzerTestOneInput()
+ * with random mutations of them:
+ *
+ *   fuzz_url [-runs=N] [-seed=S] corpus/url/<files>
+ *
+ * An input that fails a check or trips a sanitizer is saved to crash-input,
+ * and can be replayed with `fuzz_url -runs=0 crash-input`.
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#if defined(__has_include)
+  #if __has_include(<sanitizer/common_interface_defs.h>)
+    #include <sanitizer/common_interface_defs.h>
+    #define HOST_FUZZ_DEATH_CALLBACK 1
+  #endif
+#endif
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+// Bytes that tend to matter to HTTP / URL parsers
+static const char kInteresting[] = "\r\n:/?#@[]%-0123456789 \t;,=\"";
+
+static std::string current;             // input being run
+
+static void saveCrash() {
+  FILE* f = fopen("crash-input", "wb");
+  if (!f) return;
+  fwrite(current.data(), 1, current.size(), f);
+  fclose(f);
+  fprintf(stderr, "input saved to crash-input (%zu bytes)\n", current.size());
+}
+
+static void onAbort(int) {
+  saveCrash();
+  signal(SIGABRT, SIG_DFL);
+  raise(SIGABRT);
+}
+
+static void runOne(const std::string& s) {
+  current = s;
+  LLVMFuzzerTestOneInput((const uint8_t*)s.data(), s.size());
+}
+
+static void mutate(std::string& s, std::mt19937& rng) {
+  int n = 1 + rng() % 8;
+  while (n--) {
+    size_t at = s.empty() ? 0 : rng() % (s.size() + 1);
+    switch (rng() % 6) {
+      case 0:                                       // delete a run
+        if (at < s.size()) s.erase(at, 1 + rng() % 4);
+        break;
+      case 1:                                       // random byte
+        s.insert(at, 1, (char)(rng() & 0xFF));
+        break;
+      case 2:                                       // interesting byte
+        s.insert(at, 1, kInteresting[rng() % (sizeof(kInteresting) - 1)]);
+        break;
+      case 3:                                       // overwrite
+        if (at < s.size()) s[at] = kInteresting[rng() % (sizeof(kInteresting) - 1)];
+        break;
+      case 4: {                                     // duplicate a slice
+        if (s.empty()) break;
+        size_t from = rng() % s.size();
+        s.insert(at, s.substr(from, 1 + rng() % 16));
+        break;
+      }
+      default:                                      // long run
+        s.insert(at, rng() % 600, (char)("A0 \r\n"[rng() % 5]));
+        break;
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  unsigned long runs = 100000;
+  unsigned      seed = 1;
+  std::vector<std::string> corpus;
+
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "-runs=", 6) == 0) {
+      runs = strtoul(argv[i] + 6, nullptr, 10);
+    } else if (strncmp(argv[i], "-seed=", 6) == 0) {
+      seed = (unsigned)strtoul(argv[i] + 6, nullptr, 10);
+    } else {
+      std::ifstream f(argv[i], std::ios::binary);
+      std::stringstream ss;
+      ss << f.rdbuf();
+      corpus.push_back(ss.str());
+    }
+  }
+  if (corpus.empty()) corpus.push_back("");
+
+  signal(SIGABRT, onAbort);
+#ifdef HOST_FUZZ_DEATH_CALLBACK
+  __sanitizer_set_death_callback(saveCrash);
+#endif
+
+  std::mt19937 rng(seed);
+  for (const std::string& s : corpus) runOne(s);
+  for (unsigned long r = 0; r < runs; r++) {
+    std::string s = corpus[rng() % corpus.size()];
+    mutate(s, rng);
+    runOne(s);
+  }
+  printf("%lu inputs, %zu seeds: no invariant violated\n",
+         runs + corpus.size(), corpus.size());
+  return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * AsyncHTTP - fuzz target for the response side of _processSlot()
+ *
+ * The first two input bytes pick the scenario, the rest is what the server
+ * sends on every connection:
+ *   byte 0  bits 0-3  bytes readable per update() (0 = 1)
+ *           bit 4     server closes after sending everything
+ *           bit 5     HEAD instead of GET
+ *           bit 6     keep-alive
+ *           bit 7     gzip/deflate decompression
+ *   byte 1  bit 0     two requests at once (pipelined with keep-alive)
+ *           bit 1     retries (3 attempts)
+ *
+ * Invariants: every request ends in exactly one callback within its
+ * timeout, the slot is released, and a delivered response is well formed
+ * (3-digit status, Content-Length >= -1, body within its buffer, a HEAD
+ * body empty, a plain Content-Length body of exactly that length).
+ * AddressSanitizer / UBSan check memory bounds along the way.
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#include <AsyncHTTP.h>
+#include <cstdlib>
+
+#define CHECK(cond) do { if (!(cond)) { \
+  fprintf(stderr, "invariant failed: %s (line %d)\n", #cond, __LINE__); \
+  abort(); } } while (0)
+
+static const unsigned long kTimeout = 1000;
+static const int           kMaxRequests = 2;
+
+struct Outcome {
+  int  calls = 0;
+  bool head  = false;
+  bool plain = false;                   // no decompression
+};
+
+static void onResponse(const AsyncHTTPResponse& r, void* userData) {
+  Outcome& o = *(Outcome*)userData;
+  o.calls++;
+  int code = r.statusCode();
+  CHECK(code >= 100 && code <= 999);
+  CHECK(r.contentLength() >= -1);
+  CHECK(r.body().length() <= ASYNC_HTTP_BODY_BUF_SIZE);
+  if (o.head || code == 204 || code == 304) CHECK(r.body().length() == 0);
+  if (o.plain && !o.head && code >= 200 && code != 204 && code != 304 &&
+      r.contentLength() >= 0 &&
+      r.contentLength() <= ASYNC_HTTP_BODY_BUF_SIZE &&
+      r.header("Transfer-Encoding").length() == 0) {
+    CHECK((int)r.body().length() == r.contentLength());
+  }
+}
+
+static void onError(int code, const String&, void* userData) {
+  Outcome& o = *(Outcome*)userData;
+  o.calls++;
+  CHECK(code < 0);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  if (size < 2) return 0;
+  uint8_t flags  = data[0];
+  uint8_t flags2 = data[1];
+  size_t  split  = (flags & 0x0F) ? (flags & 0x0F) : 1;
+
+  hostNet            = HostNet();
+  hostNet.response.assign((const char*)data + 2, size - 2);
+  hostNet.closeAfter = flags & 0x10;
+
+  AsyncHTTP http;
+  http.begin();
+  http.setTimeout(kTimeout);
+  http.setKeepAlive(flags & 0x40);
+  if (flags & 0x40) http.setPipelining(true);
+  http.setDecompression(flags & 0x80);
+  if (flags2 & 0x02) http.setRetry(3);
+
+  Outcome out[kMaxRequests];
+  int     count = (flags2 & 0x01) ? 2 : 1;
+  for (int i = 0; i < count; i++) {
+    out[i].head  = flags & 0x20;
+    out[i].plain = !(flags & 0x80);
+    int id = http.request(out[i].head ? HTTP_HEAD : HTTP_GET, "http://fuzz/",
+                          "", "", onResponse, &out[i]);
+    CHECK(id >= 0);
+    http.onError(id, onError, &out[i]);
+  }
+  CHECK(http.pending() == count);
+
+  // Every attempt times out after kTimeout; retries back off at most
+  // ASYNC_HTTP_RETRY_MAX_DELAY
+  unsigned long limit = 4 * (kTimeout + ASYNC_HTTP_RETRY_MAX_DELAY);
+  for (unsigned long t = 0; t < limit && http.pending() > 0; t++) {
+    hostNet.budget = split;
+    hostMillis++;
+    http.update();
+  }
+  CHECK(http.pending() == 0);
+  for (int i = 0; i < count; i++) CHECK(out[i].calls == 1);
+  CHECK(hostNet.sent.compare(0, 4, out[0].head ? "HEAD" : "GET ") == 0);
+  return 0;
+}
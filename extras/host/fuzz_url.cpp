@@ -0,0 +1,88 @@
+/*
+ * AsyncHTTP - fuzz target for AsyncHTTPUrl::parse
+ *
+ * Invariants checked for every input that parses:
+ *   - all spans lie inside the string, host is never empty, port != 0
+ *   - the scheme, '@', brackets and ':' sit where the spans say
+ *   - the query is the tail of the target, after its first '?'
+ *   - rebuilding the URL from the spans parses to the same components
+ * and AsyncHTTP::get() must agree with parse() on validity (userinfo aside).
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#include <AsyncHTTP.h>
+#include <cstdlib>
+#include <string>
+
+#define CHECK(cond) do { if (!(cond)) { \
+  fprintf(stderr, "invariant failed: %s (line %d)\n", #cond, __LINE__); \
+  abort(); } } while (0)
+
+static std::string span(const char* s, const AsyncHTTPSpan& sp) {
+  return std::string(s + sp.off, sp.len);
+}
+
+static void onResponse(const AsyncHTTPResponse&, void*) {}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  std::string in((const char*)data, size);
+  const char* url = in.c_str();        // stops at the first NUL, like callers
+  size_t      len = strlen(url);
+
+  AsyncHTTPUrl u;
+  bool ok = u.parse(url);
+
+  if (ok) {
+    CHECK(u.host.len > 0 && u.port != 0);
+    CHECK((size_t)u.host.off + u.host.len <= len);
+    CHECK((size_t)u.target.off + u.target.len <= len);
+    CHECK((size_t)u.userinfo.off + u.userinfo.len <= len);
+    CHECK(u.tls == (strncasecmp(url, "https://", 8) == 0));
+
+    size_t authStart = u.tls ? 8 : 7;
+    if (u.userinfo.off) {
+      CHECK(u.userinfo.off == authStart);
+      CHECK(url[u.userinfo.off + u.userinfo.len] == '@');
+    }
+    if (u.ipv6) {
+      CHECK(url[u.host.off - 1] == '[' && url[u.host.off + u.host.len] == ']');
+    }
+    CHECK(u.target.len == 0 || url[u.target.off] == '/' ||
+          url[u.target.off] == '?');
+    CHECK(u.target.off + u.target.len == len ||
+          url[u.target.off + u.target.len] == '#');
+    if (u.query.off) {
+      CHECK(u.query.off > u.target.off && url[u.query.off - 1] == '?');
+      CHECK(u.query.off + u.query.len == u.target.off + u.target.len);
+      CHECK(memchr(url + u.target.off, '?', u.query.off - 1 - u.target.off) ==
+            nullptr);
+    }
+
+    // Round trip through the components
+    std::string rebuilt = u.tls ? "https://" : "http://";
+    if (u.userinfo.off) rebuilt += span(url, u.userinfo) + "@";
+    rebuilt += u.ipv6 ? "[" + span(url, u.host) + "]" : span(url, u.host);
+    rebuilt += ":" + std::to_string(u.port) + span(url, u.target);
+    AsyncHTTPUrl r;
+    CHECK(r.parse(rebuilt.c_str()));
+    CHECK(r.tls == u.tls && r.ipv6 == u.ipv6 && r.port == u.port);
+    CHECK(span(rebuilt.c_str(), r.host) == span(url, u.host));
+    CHECK(span(rebuilt.c_str(), r.target) == span(url, u.target));
+    CHECK(span(rebuilt.c_str(), r.query) == span(url, u.query));
+  }
+
+  // The request API accepts exactly the URLs the parser accepts, except
+  // those carrying credentials
+  static AsyncHTTP http;
+  static bool      started = false;
+  if (!started) {
+    http.begin();
+    started = true;
+  }
+  int id = http.get(String(url), onResponse);
+  CHECK((id >= 0) == (ok && u.userinfo.off == 0));
+  http.abortAll();
+  return 0;
+}
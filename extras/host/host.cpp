@@ -0,0 +1,11 @@
+/*
+ * AsyncHTTP - host build shim: globals of Arduino.h / Client.h
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#include "Client.h"
+
+unsigned long hostMillis = 0;
+HostNet       hostNet;
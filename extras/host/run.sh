@@ -0,0 +1,64 @@
+#!/bin/sh
+# Build the library on the host and run its tests, fuzz targets and
+# benchmarks.
+#
+#   ./run.sh                   build all, run the tests, the benchmarks and
+#                              a short fuzz pass of every target
+#   ./run.sh fuzz_url 1000000  fuzz one target for N inputs
+#
+# With clang (CXX=clang++) the fuzz targets are real libFuzzer binaries;
+# otherwise fuzz_main.cpp drives them with mutations of corpus/<name>/.
+# Both are built with AddressSanitizer and UBSan.
+set -e
+cd "$(dirname "$0")"
+
+CXX=${CXX:-c++}
+OUT=build
+FLAGS="-std=gnu++17 -g -O1 -Wall -Wextra -I. -I../../src"
+SAN="-fsanitize=address,undefined -fno-sanitize-recover=all"
+LIB="../../src/*.cpp host.cpp"
+FUZZERS="fuzz_url fuzz_response"
+BENCHES="bench_url"
+TESTS="test_retry"
+
+mkdir -p "$OUT"
+if echo 'extern "C" int LLVMFuzzerTestOneInput(const char*, long) { return 0; }' |
+   $CXX -x c++ -fsanitize=fuzzer - -o "$OUT/.probe" 2>/dev/null; then
+  FUZZ="-fsanitize=fuzzer"
+  DRIVER=""
+else
+  FUZZ=""
+  DRIVER="fuzz_main.cpp"
+fi
+
+build_fuzzer() {
+  $CXX $FLAGS $SAN $FUZZ $LIB $DRIVER "$1.cpp" -o "$OUT/$1"
+}
+
+run_fuzzer() {
+  corpus="corpus/${1#fuzz_}"
+  if [ -n "$FUZZ" ]; then
+    "$OUT/$1" -runs="$2" "$corpus"
+  else
+    "$OUT/$1" -runs="$2" "$corpus"/*
+  fi
+}
+
+if [ -n "$1" ]; then
+  build_fuzzer "$1"
+  run_fuzzer "$1" "${2:-1000000}"
+  exit
+fi
+
+for t in $TESTS; do
+  $CXX $FLAGS $SAN $LIB "$t.cpp" -o "$OUT/$t"
+  "$OUT/$t"
+done
+for b in $BENCHES; do
+  $CXX $FLAGS -O2 $LIB "$b.cpp" -o "$OUT/$b"
+  "$OUT/$b"
+done
+for f in $FUZZERS; do
+  build_fuzzer "$f"
+  run_fuzzer "$f" 50000
+done
@@ -0,0 +1,61 @@
+/*
+ * AsyncHTTP - host test of which failures setRetry() repeats
+ *
+ * Once response bytes have arrived the server has acted on the request, so
+ * a truncated response may only be retried for idempotent methods.
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#include <AsyncHTTP.h>
+
+static int failures = 0;
+
+#define CHECK(cond) do { if (!(cond)) { \
+  fprintf(stderr, "check failed: %s (line %d)\n", #cond, __LINE__); \
+  failures++; } } while (0)
+
+static int lastError = 0;
+
+static void onResponse(const AsyncHTTPResponse&, void*) {}
+static void onError(int code, const String&, void*) { lastError = code; }
+
+// Run one request against hostNet until it has finished
+static void run(AsyncHTTPMethod method) {
+  AsyncHTTP http;
+  http.begin();
+  http.setRetry(3);
+  http.onError(onError);
+  lastError        = 0;
+  hostNet.connects = 0;
+  CHECK(http.request(method, "http://host/", "x=1", "text/plain",
+                     onResponse) >= 0);
+  for (unsigned long t = 0; t < 100000 && http.pending() > 0; t++) {
+    hostNet.budget = 64;
+    hostMillis++;
+    http.update();
+  }
+  CHECK(http.pending() == 0);
+}
+
+int main() {
+  // Content-Length promises more than the server sends before closing
+  hostNet.response   = "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nabc";
+  hostNet.closeAfter = true;
+
+  run(HTTP_POST);
+  CHECK(lastError == ASYNC_HTTP_ERR_INCOMPLETE);
+  CHECK(hostNet.connects == 1);         // sent once, never repeated
+
+  run(HTTP_PATCH);
+  CHECK(lastError == ASYNC_HTTP_ERR_INCOMPLETE);
+  CHECK(hostNet.connects == 1);
+
+  run(HTTP_GET);
+  CHECK(lastError == ASYNC_HTTP_ERR_INCOMPLETE);
+  CHECK(hostNet.connects == 3);         // idempotent: every attempt used
+
+  printf("test_retry: %s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
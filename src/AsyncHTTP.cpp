@@ -7,6 +7,13 @@
  */
 
 #include "AsyncHTTP.h"
+#include "AsyncHTTPBatch.h"
+#include "AsyncHTTPCache.h"
+#include "AsyncHTTPDeflate.h"
+#include "AsyncHTTPEvents.h"
+#include "AsyncHTTPInflate.h"
+#include "AsyncHTTPMultipart.h"
+#include "AsyncHTTPWebSocket.h"
 
 // ===========================================================================
 // AsyncHTTPResponse helpers
@@ -30,11 +37,13 @@ void AsyncHTTPResponse::_addHeader(const String& name, const String& value) {
 }
 
 // ===========================================================================
-// AsyncHTTPRequest::reset
+// AsyncHTTPRequest::reset / resetResponse / storeBody
 // ===========================================================================
 
 void AsyncHTTPRequest::reset() {
+  unlinkToken();
   active          = false;
+  id              = -1;
   state           = STATE_IDLE;
   method          = HTTP_GET;
   host            = "";
@@ -43,24 +52,159 @@ void AsyncHTTPRequest::reset() {
   tls             = false;
   requestHeaders  = "";
   requestBody     = "";
+  contentType     = "";
+  tmpl            = nullptr;
+  multipart       = nullptr;
+#if ASYNC_HTTP_JSON
+  jsonBody        = nullptr;
+#endif
+  if (ws) ws->_release();               // aborted while connecting / open
+  ws              = nullptr;
+  longPoll        = false;
+  redirects       = 0;
+  rangeNext       = 0;
+  rangeEnd        = -1;
+  ifRange         = "";
+  group           = -1;
+  cacheKey        = "";
+  cacheHit        = false;
   timeoutMs       = ASYNC_HTTP_DEFAULT_TIMEOUT;
   startTime       = 0;
+  resetResponse();
+#if ASYNC_HTTP_JSON
+  jsonState       = JSON_OFF;
+  jsonFilter      = nullptr;
+  onJsonCb        = nullptr;
+#endif
+
+  conn            = -1;
+  pipeNext        = -1;
+  reissued        = false;
+  noPipeline      = false;
+  attempts        = 0;
+  retryAt         = 0;
+  breakerProbe    = false;
+  rateAdmitted    = false;
+
+  onResponseCb   = nullptr;
+  onResponseData  = nullptr;
+  onErrorCb       = nullptr;
+  onErrorData     = nullptr;
+  onDataCb        = nullptr;
+  onEventCb       = nullptr;
+  delete events;
+  events          = nullptr;
+  waiterCount     = 0;
+
+  // NOTE: the pool detaches the connection before a slot is reset
+  client          = nullptr;
+}
+
+// Leave the cancellation token's list of requests
+void AsyncHTTPRequest::unlinkToken() {
+  if (!token) return;
+  if (tokenPrev) tokenPrev->tokenNext = tokenNext;
+  else           token->_head         = tokenNext;
+  if (tokenNext) tokenNext->tokenPrev = tokenPrev;
+  token->_count--;
+  token     = nullptr;
+  tokenPrev = nullptr;
+  tokenNext = nullptr;
+}
+
+// Clear the parser state only – used when a request is re-sent on a new
+// connection after the previous socket was closed underneath it
+void AsyncHTTPRequest::resetResponse() {
   headersDone     = false;
   chunked         = false;
   remainingBytes  = -1;
   _headerLineBuf  = "";
+  chunkState      = 0;
+  chunkRemaining  = 0;
+  connClose       = false;
+  gotBytes        = false;
+  drained         = false;
+  streamBody      = false;
+  streamEvents    = false;
+  releaseInflate();
+#if ASYNC_HTTP_JSON
+  if (jsonState != JSON_OFF) jsonState = JSON_WANTED;
+  delete json;
+  json            = nullptr;
+#endif
 
-  // Reset response
   response._statusCode    = 0;
   response._body          = "";
   response._contentLength = -1;
   response._headerCount   = 0;
+}
 
-  onResponseCb   = nullptr;
-  onResponseData  = nullptr;
-  onErrorCb       = nullptr;
-  onErrorData     = nullptr;
-  // NOTE: client pointer is NOT reset; it is managed by the pool
+// Store decoded body bytes. Safety: limit body size (excess bytes are
+// consumed but dropped). Download bodies are collected into pieces of
+// ASYNC_HTTP_DOWNLOAD_CHUNK bytes and handed to onDataCb instead.
+void AsyncHTTPRequest::storeBody(const uint8_t* data, size_t len) {
+  if (streamEvents) {
+    startTime = millis();               // reconnect only when idle
+    for (size_t i = 0; i < len; i++) {
+      if (events->feed((char)data[i])) {
+        onEventCb(events->event(), events->data(), events->lastId(),
+                  onResponseData);
+        if (!active) return;            // aborted from onEvent
+      }
+    }
+    return;
+  }
+  if (streamBody) {
+    startTime = millis();               // downloads only time out when idle
+    response._body.concat((const char*)data, len);
+    if (response._body.length() >= ASYNC_HTTP_DOWNLOAD_CHUNK) flushBody();
+    return;
+  }
+  size_t limit = ASYNC_HTTP_BODY_BUF_SIZE;
+#if ASYNC_HTTP_JSON
+  // A JSON body has its own limit; one byte more marks it as too large
+  if (jsonState == JSON_COLLECTING) limit = ASYNC_HTTP_JSON_BODY_SIZE + 1;
+#endif
+  size_t have = response._body.length();
+  if (have >= limit) return;
+  if (len > limit - have) len = limit - have;
+  response._body.concat((const char*)data, len);
+}
+
+// Deliver the collected download bytes; progress renews the resume budget
+void AsyncHTTPRequest::flushBody() {
+  size_t len = response._body.length();
+  if (!streamBody || len == 0) return;
+  onDataCb((const uint8_t*)response._body.c_str(), len, rangeNext,
+           onResponseData);
+  rangeNext += len;
+  attempts   = 0;
+  response._body = "";
+}
+
+// Run the content decoder on compressed bytes, or flush it if `len` is 0.
+// A callback reached through its sink may abort the request; the decoder is
+// then freed here, once it has returned. Returns false if decoding failed.
+bool AsyncHTTPRequest::inflateInput(const uint8_t* data, size_t len) {
+  AsyncHTTPInflate* dec = inflate;
+  bool ok = true;
+  inflateBusy = true;
+  if (len > 0) {
+    ok = dec->write(data, len) != AsyncHTTPInflate::INFLATE_ERROR;
+  } else {
+    dec->flush();
+  }
+  inflateBusy = false;
+  if (inflate != dec) {                 // released from a callback
+    delete dec;
+    return true;
+  }
+  return ok;
+}
+
+void AsyncHTTPRequest::releaseInflate() {
+  if (!inflateBusy) delete inflate;     // otherwise inflateInput() frees it
+  inflate = nullptr;
 }
 
 // ===========================================================================
@@ -68,17 +212,15 @@ void AsyncHTTPRequest::reset() {
 // ===========================================================================
 
 AsyncHTTP::AsyncHTTP() {
-  memset(_ownedClients, 0, sizeof(_ownedClients));
+  _initSlots();
 }
 
 AsyncHTTP::~AsyncHTTP() {
   abortAll();
-  if (_ownsClients) {
-    for (uint8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
-      if (_ownedClients[i]) {
-        _destroyClient(_ownedClients[i], _requests[i].tls);
-        _ownedClients[i] = nullptr;
-      }
+  for (uint8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
+    if (_conns[i].owned && _conns[i].client) {
+      _destroyClient(_conns[i].client, _conns[i].tls);
+      _conns[i].client = nullptr;
     }
   }
 }
@@ -90,8 +232,9 @@ void AsyncHTTP::begin() {
   _ownsClients = true;
   for (uint8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
     _requests[i].reset();
-    _requests[i].client = nullptr; // lazily created on demand
+    _conns[i] = AsyncHTTPConnection(); // clients lazily created on demand
   }
+  _initSlots();
 }
 
 // ---------------------------------------------------------------------------
@@ -102,8 +245,10 @@ void AsyncHTTP::begin(Client* clients[], uint8_t count) {
   uint8_t n = min((uint8_t)ASYNC_HTTP_MAX_REQUESTS, count);
   for (uint8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
     _requests[i].reset();
-    _requests[i].client = (i < n) ? clients[i] : nullptr;
+    _conns[i] = AsyncHTTPConnection();
+    _conns[i].client = (i < n) ? clients[i] : nullptr;
   }
+  _initSlots();
 }
 
 // ===========================================================================
@@ -155,6 +300,48 @@ int AsyncHTTP::patchJson(const String& url, const String& jsonBody,
   return request(HTTP_PATCH, url, jsonBody, "application/json", onResponse, userData);
 }
 
+int AsyncHTTP::postMultipart(const String& url, AsyncHTTPMultipart& form,
+                             AsyncHTTPRequest::ResponseCallback onResponse,
+                             void* userData) {
+  int id = request(HTTP_POST, url, "", form.contentType(), onResponse,
+                   userData);
+  if (id >= 0) {
+    form.start();
+    _requests[_slotFor(id)].multipart = &form;
+  }
+  return id;
+}
+
+#if ASYNC_HTTP_JSON
+int AsyncHTTP::postJson(const String& url, const JsonDocument& json,
+                        AsyncHTTPRequest::ResponseCallback onResponse,
+                        void* userData) {
+  return _sendJson(HTTP_POST, url, json, onResponse, userData);
+}
+
+int AsyncHTTP::putJson(const String& url, const JsonDocument& json,
+                       AsyncHTTPRequest::ResponseCallback onResponse,
+                       void* userData) {
+  return _sendJson(HTTP_PUT, url, json, onResponse, userData);
+}
+
+int AsyncHTTP::patchJson(const String& url, const JsonDocument& json,
+                         AsyncHTTPRequest::ResponseCallback onResponse,
+                         void* userData) {
+  return _sendJson(HTTP_PATCH, url, json, onResponse, userData);
+}
+
+// The body stays in the document until _sendRequest() serializes it
+int AsyncHTTP::_sendJson(AsyncHTTPMethod method, const String& url,
+                         const JsonDocument& json,
+                         AsyncHTTPRequest::ResponseCallback onResponse,
+                         void* userData) {
+  int id = request(method, url, "", "application/json", onResponse, userData);
+  if (id >= 0) _requests[_slotFor(id)].jsonBody = &json;
+  return id;
+}
+#endif
+
 int AsyncHTTP::del(const String& url,
                    AsyncHTTPRequest::ResponseCallback onResponse,
                    void* userData) {
@@ -171,14 +358,24 @@ int AsyncHTTP::request(AsyncHTTPMethod method,
                        const String& contentType,
                        AsyncHTTPRequest::ResponseCallback onResponse,
                        void* userData) {
+  // Identical GET already in flight – share its response
+  if (_coalesce && method == HTTP_GET) {
+    int shared = _joinInFlight(url, onResponse, userData);
+    if (shared >= 0) return shared;
+  }
+  return _newRequest(method, url, body, contentType, onResponse, userData);
+}
+
+// A request on a slot of its own (never joined to an identical GET)
+int AsyncHTTP::_newRequest(AsyncHTTPMethod method,
+                           const String& url,
+                           const String& body,
+                           const String& contentType,
+                           AsyncHTTPRequest::ResponseCallback onResponse,
+                           void* userData) {
   int slot = _allocSlot();
   if (slot < 0) {
-    // Fire global error callback
-    if (_globalErrorCb) {
-      _globalErrorCb(ASYNC_HTTP_ERR_POOL_FULL,
-                     F("Request pool full"), _globalErrorData);
-    }
-    return ASYNC_HTTP_ERR_POOL_FULL;
+    return _rejectRequest(ASYNC_HTTP_ERR_POOL_FULL, F("Request pool full"));
   }
 
   AsyncHTTPRequest& req = _requests[slot];
@@ -186,286 +383,1386 @@ int AsyncHTTP::request(AsyncHTTPMethod method,
 
   // ---- Parse URL ----
   if (!_parseUrl(url, req.host, req.port, req.path, req.tls)) {
-    req.reset();
-    if (_globalErrorCb) {
-      _globalErrorCb(ASYNC_HTTP_ERR_INVALID_URL,
-                     F("Invalid URL"), _globalErrorData);
-    }
-    return ASYNC_HTTP_ERR_INVALID_URL;
+    return _rejectRequest(ASYNC_HTTP_ERR_INVALID_URL, F("Invalid URL"), &req);
   }
 
   req.requestBody     = body;
-  req.timeoutMs       = _defaultTimeout;
+  req.contentType     = contentType;
   req.onResponseCb    = onResponse;
   req.onResponseData  = userData;
-  req.onErrorCb       = _globalErrorCb;
-  req.onErrorData     = _globalErrorData;
 
   // Build HTTP header block
-  _buildRequestHeader(req, body, contentType);
-
-  // ---- Create / reuse client ----
-  if (!req.client) {
-    req.client = _createClient(req.tls);
-    if (_ownsClients) {
-      _ownedClients[slot] = req.client;
-    }
-  }
-
-  // ---- Start async connect ----
-  req.state     = STATE_CONNECTING;
-  req.startTime = millis();
-  req.active    = true;
+  _buildRequestHeader(req.requestHeaders, method, req.host, req.port,
+                      req.tls, req.path, contentType);
+  if (_cache) _cacheLookup(req, url);
 
-  return slot;  // return request ID
+  return _startSlot(req);  // request ID
 }
 
+#if ASYNC_HTTP_JSON
 // ===========================================================================
-// Settings
+// JSON responses
 // ===========================================================================
 
-void AsyncHTTP::setHeader(const String& name, const String& value) {
-  _defaultHeaders += name + ": " + value + "\r\n";
+int AsyncHTTP::getJson(const String& url,
+                       AsyncHTTPRequest::JsonCallback onJson,
+                       void* userData) {
+  return requestJson(HTTP_GET, url, "", "", nullptr, onJson, userData);
 }
 
-void AsyncHTTP::clearHeaders() {
-  _defaultHeaders = "";
+int AsyncHTTP::getJson(const String& url,
+                       const JsonDocument& filter,
+                       AsyncHTTPRequest::JsonCallback onJson,
+                       void* userData) {
+  return requestJson(HTTP_GET, url, "", "", &filter, onJson, userData);
 }
 
-void AsyncHTTP::setTimeout(unsigned long ms) {
-  _defaultTimeout = ms;
-}
+// Like request(), but never shared or served from the cache: a 2xx body is
+// collected and parsed into a JsonDocument once complete
+int AsyncHTTP::requestJson(AsyncHTTPMethod method,
+                           const String& url,
+                           const String& body,
+                           const String& contentType,
+                           const JsonDocument* filter,
+                           AsyncHTTPRequest::JsonCallback onJson,
+                           void* userData) {
+  int slot = _allocSlot();
+  if (slot < 0) {
+    return _rejectRequest(ASYNC_HTTP_ERR_POOL_FULL, F("Request pool full"));
+  }
 
-void AsyncHTTP::onError(AsyncHTTPRequest::ErrorCallback cb, void* userData) {
-  _globalErrorCb   = cb;
-  _globalErrorData  = userData;
+  AsyncHTTPRequest& req = _requests[slot];
+  req.method = method;
+  if (!onJson || !_parseUrl(url, req.host, req.port, req.path, req.tls)) {
+    return _rejectRequest(ASYNC_HTTP_ERR_INVALID_URL, F("Invalid URL"), &req);
+  }
+
+  req.requestBody     = body;
+  req.contentType     = contentType;
+  req.jsonState       = AsyncHTTPRequest::JSON_WANTED;
+  req.jsonFilter      = filter;
+  req.onJsonCb        = onJson;
+  req.onResponseData  = userData;
+  _buildRequestHeader(req.requestHeaders, method, req.host, req.port,
+                      req.tls, req.path, contentType);
+
+  return _startSlot(req);
 }
+#endif
 
 // ===========================================================================
-// update()  – MUST be called in loop()
+// Batches
 // ===========================================================================
 
-void AsyncHTTP::update() {
-  for (uint8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
-    if (_requests[i].active) {
-      _processSlot(_requests[i]);
-    }
+bool AsyncHTTP::batch(AsyncHTTPBatch& batch) {
+  if (batch._http || batch._count == 0) return false;
+  for (uint8_t i = 0; i < batch._count; i++) {
+    AsyncHTTPBatch::Item& it = batch._items[i];
+    it.state    = AsyncHTTPBatch::ITEM_QUEUED;
+    it.id       = -1;
+    it.status   = 0;
+    it.response = "";
   }
+  batch._http = this;
+  AsyncHTTPBatch** p = &_batches;       // appended: batches start in order
+  while (*p) p = &(*p)->_next;
+  *p = &batch;
+  _submitBatch(batch);
+  return true;
 }
 
-uint8_t AsyncHTTP::pending() const {
-  uint8_t n = 0;
-  for (uint8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
-    if (_requests[i].active) n++;
+// ===========================================================================
+// Prepared requests
+// ===========================================================================
+
+bool AsyncHTTP::prepare(AsyncHTTPTemplate& tpl, AsyncHTTPMethod method,
+                        const String& url, const String& contentType) {
+  String path;
+  tpl._valid  = false;
+  tpl._method = method;
+  tpl._header = "";
+  if (!_parseUrl(url, tpl._host, tpl._port, path, tpl._tls)) {
+    return false;
   }
-  return n;
+  tpl._path        = path;
+  tpl._contentType = contentType;
+  _buildRequestHeader(tpl._header, method, tpl._host, tpl._port, tpl._tls,
+                      path, contentType);
+  tpl._valid = true;
+  return true;
 }
 
-void AsyncHTTP::abort(int requestId) {
-  if (requestId >= 0 && requestId < ASYNC_HTTP_MAX_REQUESTS) {
-    AsyncHTTPRequest& req = _requests[requestId];
-    if (req.active && req.client) {
-      req.client->stop();
-    }
-    if (_ownsClients && _ownedClients[requestId]) {
-      _destroyClient(_ownedClients[requestId], req.tls);
-      _ownedClients[requestId] = nullptr;
-    }
-    req.reset();
-    req.client = nullptr;
+int AsyncHTTP::send(const AsyncHTTPTemplate& tpl, const String& body,
+                    AsyncHTTPRequest::ResponseCallback onResponse,
+                    void* userData) {
+  if (!tpl._valid) {
+    return _rejectRequest(ASYNC_HTTP_ERR_INVALID_URL, F("Invalid URL"));
   }
-}
 
-void AsyncHTTP::abortAll() {
-  for (uint8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
-    abort(i);
+  int slot = _allocSlot();
+  if (slot < 0) {
+    return _rejectRequest(ASYNC_HTTP_ERR_POOL_FULL, F("Request pool full"));
   }
+
+  AsyncHTTPRequest& req = _requests[slot];
+  req.method          = tpl._method;
+  req.tmpl            = &tpl;
+  req.port            = tpl._port;
+  req.tls             = tpl._tls;
+  req.requestBody     = body;
+  req.onResponseCb    = onResponse;
+  req.onResponseData  = userData;
+
+  return _startSlot(req);
 }
 
-// ===========================================================================
-// Internal: allocate a slot
-// ===========================================================================
+// ---------------------------------------------------------------------------
+// An API call that cannot start its request: clear the slot it was filling
+// (still on the free list), tell the global error callback, return the code
+// ---------------------------------------------------------------------------
+int AsyncHTTP::_rejectRequest(int code, const String& message,
+                              AsyncHTTPRequest* req) {
+  if (req) req->reset();
+  if (_globalErrorCb) _globalErrorCb(code, message, _globalErrorData);
+  return code;
+}
 
-int AsyncHTTP::_allocSlot() {
-  for (uint8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
-    if (!_requests[i].active) {
-      _requests[i].reset();
-      return i;
-    }
+// ---------------------------------------------------------------------------
+// Common tail of request()/send(): the socket is picked from the pool in
+// STATE_CONNECTING. A throttled request is refused here, before it takes the
+// slot, so a backlog for one rate-limited host cannot fill the pool.
+// ---------------------------------------------------------------------------
+int AsyncHTTP::_startSlot(AsyncHTTPRequest& req) {
+  if (!_rateAllow(req)) {
+    return _rejectRequest(ASYNC_HTTP_ERR_RATE_LIMITED, F("Rate limited"), &req);
   }
-  return -1;
+
+  req.timeoutMs       = _defaultTimeout;
+  req.onErrorCb       = _globalErrorCb;
+  req.onErrorData     = _globalErrorData;
+
+  // ---- Start async connect ----
+  req.state     = STATE_CONNECTING;
+  req.startTime = millis();
+  req.active    = true;
+
+  // Pop the slot off the free list: _allocSlot() returned its head, and an
+  // API call allocates nothing else before it starts the request
+  _freeHead = req.nextFree;
+  _activeSlots[req.slot / 32] |= 1UL << (req.slot % 32);
+  _activeCount++;
+  return req.id;
 }
 
 // ===========================================================================
-// Internal: parse URL   http(s)://host(:port)/path
+// Downloads
 // ===========================================================================
 
-bool AsyncHTTP::_parseUrl(const String& url, String& host, uint16_t& port,
-                          String& path, bool& tls) {
-  String u = url;
-  tls = false;
+int AsyncHTTP::download(const String& url,
+                        AsyncHTTPRequest::DataCallback onData,
+                        AsyncHTTPRequest::ResponseCallback onDone,
+                        void* userData) {
+  return downloadRange(url, 0, -1, onData, onDone, userData);
+}
 
-  if (u.startsWith("https://")) {
-    tls = true;
-    u = u.substring(8);
-  } else if (u.startsWith("http://")) {
-    u = u.substring(7);
-  } else {
-    return false;  // unsupported scheme
+int AsyncHTTP::downloadRange(const String& url, uint32_t from, long to,
+                             AsyncHTTPRequest::DataCallback onData,
+                             AsyncHTTPRequest::ResponseCallback onDone,
+                             void* userData) {
+  int slot = _allocSlot();
+  if (slot < 0) {
+    return _rejectRequest(ASYNC_HTTP_ERR_POOL_FULL, F("Request pool full"));
   }
 
-  // Separate host(+port) from path
-  int slashIdx = u.indexOf('/');
-  String hostPort;
-  if (slashIdx < 0) {
-    hostPort = u;
-    path = "/";
-  } else {
-    hostPort = u.substring(0, slashIdx);
-    path = u.substring(slashIdx);
+  AsyncHTTPRequest& req = _requests[slot];
+  if (!onData || (to >= 0 && (uint32_t)to < from) ||
+      !_parseUrl(url, req.host, req.port, req.path, req.tls)) {
+    return _rejectRequest(ASYNC_HTTP_ERR_INVALID_URL, F("Invalid URL"), &req);
   }
 
-  // Port
-  int colonIdx = hostPort.indexOf(':');
-  if (colonIdx > 0) {
-    host = hostPort.substring(0, colonIdx);
-    port = (uint16_t)hostPort.substring(colonIdx + 1).toInt();
-  } else {
-    host = hostPort;
-    port = tls ? 443 : 80;
+  req.method          = HTTP_GET;
+  req.rangeNext       = from;
+  req.rangeEnd        = to;
+  req.onDataCb        = onData;
+  req.onResponseCb    = onDone;
+  req.onResponseData  = userData;
+  _buildRequestHeader(req.requestHeaders, HTTP_GET, req.host, req.port,
+                      req.tls, req.path, "", true);
+
+  return _startSlot(req);
+}
+
+int AsyncHTTP::downloadParallel(const String& url, uint32_t size,
+                                uint8_t parts,
+                                AsyncHTTPRequest::DataCallback onData,
+                                AsyncHTTPRequest::ResponseCallback onDone,
+                                void* userData) {
+  uint8_t idle = ASYNC_HTTP_MAX_REQUESTS - pending();
+  if (parts > idle) parts = idle;
+  if (parts > size) parts = (uint8_t)size;
+  if (parts <= 1) return download(url, onData, onDone, userData);
+
+  uint32_t partSize = size / parts;
+  int      first    = -1;
+  for (uint8_t i = 0; i < parts; i++) {
+    uint32_t from = i * partSize;
+    long     to   = (i == parts - 1) ? (long)size - 1 : (long)(from + partSize - 1);
+    int id = downloadRange(url, from, to, onData, onDone, userData);
+    if (id < 0) {
+      if (first >= 0) abort(first);
+      return id;
+    }
+    if (first < 0) first = id;
+    _requests[_slotFor(id)].group = _slotFor(first);
   }
+  return first;
+}
 
-  return host.length() > 0;
+long AsyncHTTP::downloadSize(int requestId) const {
+  int8_t i = _slotFor(requestId);
+  if (i < 0) return -1;
+  const AsyncHTTPRequest& req = _requests[i];
+  if (!req.onDataCb || req.rangeEnd < 0) return -1;
+  return req.rangeEnd + 1;
 }
 
 // ===========================================================================
-// Internal: build the HTTP request header string
+// Server-Sent Events
 // ===========================================================================
 
-void AsyncHTTP::_buildRequestHeader(AsyncHTTPRequest& req,
-                                     const String& body,
-                                     const String& contentType) {
-  static const char* methodNames[] = {
-    "GET", "POST", "PUT", "PATCH", "DELETE", "HEAD"
-  };
+int AsyncHTTP::sse(const String& url,
+                   AsyncHTTPRequest::EventCallback onEvent,
+                   AsyncHTTPRequest::ResponseCallback onClose,
+                   void* userData) {
+  int slot = _allocSlot();
+  if (slot < 0) {
+    return _rejectRequest(ASYNC_HTTP_ERR_POOL_FULL, F("Request pool full"));
+  }
 
-  String h;
-  h.reserve(256);
+  AsyncHTTPRequest& req = _requests[slot];
+  if (!onEvent || !_parseUrl(url, req.host, req.port, req.path, req.tls)) {
+    return _rejectRequest(ASYNC_HTTP_ERR_INVALID_URL, F("Invalid URL"), &req);
+  }
+  req.events = new AsyncHTTPEventParser();
+  if (!req.events) {
+    return _rejectRequest(ASYNC_HTTP_ERR_NO_MEMORY,
+                          F("Out of memory for event stream"), &req);
+  }
 
-  // Request line
-  h += methodNames[(int)req.method];
-  h += ' ';
-  h += req.path;
-  h += F(" HTTP/1.1\r\n");
+  req.method          = HTTP_GET;
+  req.onEventCb       = onEvent;
+  req.onResponseCb    = onClose;
+  req.onResponseData  = userData;
+  _buildRequestHeader(req.requestHeaders, HTTP_GET, req.host, req.port,
+                      req.tls, req.path, "", true);
 
-  // Host header
-  h += F("Host: ");
-  h += req.host;
-  if ((req.tls && req.port != 443) || (!req.tls && req.port != 80)) {
-    h += ':';
-    h += String(req.port);
-  }
-  h += F("\r\n");
+  int id = _startSlot(req);
+  if (id >= 0) req.timeoutMs = ASYNC_HTTP_SSE_IDLE_TIMEOUT;
+  return id;
+}
 
-  // Default headers
-  if (_defaultHeaders.length() > 0) {
-    h += _defaultHeaders;
-  }
+// ===========================================================================
+// Long polling
+// ===========================================================================
 
-  // Content-Type
-  if (contentType.length() > 0) {
-    h += F("Content-Type: ");
-    h += contentType;
-    h += F("\r\n");
+int AsyncHTTP::longPoll(const String& url, unsigned long holdMs,
+                        AsyncHTTPRequest::ResponseCallback onResponse,
+                        void* userData) {
+  int slot = _allocSlot();
+  if (slot < 0) {
+    return _rejectRequest(ASYNC_HTTP_ERR_POOL_FULL, F("Request pool full"));
   }
 
-  // Content-Length
-  if (body.length() > 0) {
-    h += F("Content-Length: ");
-    h += String(body.length());
-    h += F("\r\n");
+  AsyncHTTPRequest& req = _requests[slot];
+  if (!onResponse || !_parseUrl(url, req.host, req.port, req.path, req.tls)) {
+    return _rejectRequest(ASYNC_HTTP_ERR_INVALID_URL, F("Invalid URL"), &req);
   }
 
-  // Connection: close (simpler to handle)
-  h += F("Connection: close\r\n");
-  h += F("\r\n");
+  req.method          = HTTP_GET;
+  req.longPoll        = true;
+  req.onResponseCb    = onResponse;
+  req.onResponseData  = userData;
+  _buildRequestHeader(req.requestHeaders, HTTP_GET, req.host, req.port,
+                      req.tls, req.path, "");
 
-  req.requestHeaders = h;
+  int id = _startSlot(req);
+  if (id >= 0) req.timeoutMs = holdMs;
+  return id;
 }
 
 // ===========================================================================
-// Internal: chunked encoding helper (forward declaration)
+// WebSockets
 // ===========================================================================
 
-// A simple helper that strips chunked transfer-encoding framing from the body.
-// Works for typical small-to-medium responses.
-static void _stripChunkedEncoding(String& body) {
-  String result;
-  result.reserve(body.length());
-  int pos = 0;
-  int len = body.length();
-
-  while (pos < len) {
-    // Find end of chunk size line
-    int lineEnd = body.indexOf("\r\n", pos);
-    if (lineEnd < 0) break;
+int AsyncHTTP::websocket(const String& url, AsyncHTTPWebSocket& ws) {
+  if (ws._http) ws._http->abort(ws._id);
 
-    // Parse chunk size (hex)
-    String sizeStr = body.substring(pos, lineEnd);
-    sizeStr.trim();
-    long chunkSize = strtol(sizeStr.c_str(), nullptr, 16);
-    if (chunkSize <= 0) break;  // terminal chunk or error
+  int slot = _allocSlot();
+  if (slot < 0) {
+    return _rejectRequest(ASYNC_HTTP_ERR_POOL_FULL, F("Request pool full"));
+  }
 
-    int dataStart = lineEnd + 2;
-    int dataEnd   = dataStart + (int)chunkSize;
-    if (dataEnd > len) dataEnd = len;
+  // ws:// and wss:// name the same endpoints as http:// and https://
+  String target;
+  if (url.startsWith("ws://")) {
+    target = F("http://");
+    target += url.c_str() + 5;
+  } else if (url.startsWith("wss://")) {
+    target = F("https://");
+    target += url.c_str() + 6;
+  } else {
+    target = url;
+  }
 
-    result += body.substring(dataStart, dataEnd);
-    pos = dataEnd + 2; // skip trailing \r\n after chunk data
+  AsyncHTTPRequest& req = _requests[slot];
+  if (!_parseUrl(target, req.host, req.port, req.path, req.tls)) {
+    return _rejectRequest(ASYNC_HTTP_ERR_INVALID_URL, F("Invalid URL"), &req);
   }
 
-  body = result;
+  req.method = HTTP_GET;
+  req.ws     = &ws;
+  _buildRequestHeader(req.requestHeaders, HTTP_GET, req.host, req.port,
+                      req.tls, req.path, "", true);
+
+  int id = _startSlot(req);
+  if (id >= 0) ws._begin(this, id);
+  return id;
 }
 
 // ===========================================================================
-// Internal: per-slot state machine   (called from update())
+// Settings
 // ===========================================================================
 
-void AsyncHTTP::_processSlot(AsyncHTTPRequest& req) {
-  if (!req.client) return;
+void AsyncHTTP::setHeader(const String& name, const String& value) {
+  _defaultHeaders += name + ": " + value + "\r\n";
+}
 
-  // ---- Timeout check ----
-  if (req.state != STATE_COMPLETE && req.state != STATE_ERROR &&
-      req.state != STATE_IDLE) {
-    if (millis() - req.startTime > req.timeoutMs) {
-      _finishWithError(req, ASYNC_HTTP_ERR_TIMEOUT, F("Request timed out"));
-      return;
+void AsyncHTTP::clearHeaders() {
+  _defaultHeaders = "";
+}
+
+void AsyncHTTP::setTimeout(unsigned long ms) {
+  _defaultTimeout = ms;
+}
+
+void AsyncHTTP::onError(AsyncHTTPRequest::ErrorCallback cb, void* userData) {
+  _globalErrorCb   = cb;
+  _globalErrorData  = userData;
+}
+
+void AsyncHTTP::onError(int requestId, AsyncHTTPRequest::ErrorCallback cb,
+                        void* userData) {
+  int8_t i = _slotFor(requestId);
+  if (i >= 0) {
+    _requests[i].onErrorCb   = cb;
+    _requests[i].onErrorData = userData;
+  }
+}
+
+void AsyncHTTP::setKeepAlive(bool enable) {
+  _keepAlive = enable;
+  if (!enable) {
+    _pipelineDepth = 0;
+    // Drop idle sockets; busy ones close when their response completes
+    for (int8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
+      if (_conns[i].open && _conns[i].users == 0) _closeConnection(i, false, -1);
     }
   }
+}
 
-  switch (req.state) {
+void AsyncHTTP::setDecompression(bool enable, size_t windowSize) {
+  _decompress    = enable;
+  _inflateWindow = windowSize;
+}
 
-    // ---------------------------------------------------------------
-    case STATE_CONNECTING: {
-      // Try non-blocking connect
-      if (req.client->connected()) {
-        req.state = STATE_SENDING;
-        break;
-      }
+void AsyncHTTP::setCompression(bool enable, size_t windowSize) {
+  _compress      = enable;
+  _deflateWindow = windowSize;
+}
 
-      // Attempt connect (on most Arduino cores this is blocking the first
-      // time, but returns quickly on subsequent calls if already connected)
-      int rc;
-#if ASYNC_HTTP_SSL_SUPPORT
-      if (req.tls) {
-  #if defined(ESP32)
-        WiFiClientSecure* sc = static_cast<WiFiClientSecure*>(req.client);
-        if (_insecure) sc->setInsecure();
-  #endif
-      }
-#endif
-      rc = req.client->connect(req.host.c_str(), req.port);
+void AsyncHTTP::setCache(AsyncHTTPCacheStore* store) {
+  _cache = store;
+}
+
+void AsyncHTTP::setCoalescing(bool enable) {
+  _coalesce = enable;
+}
+
+void AsyncHTTP::setRetry(uint8_t maxAttempts, unsigned long baseDelayMs,
+                         unsigned long maxDelayMs) {
+  _retryMax      = maxAttempts;
+  _retryBase     = baseDelayMs;
+  _retryMaxDelay = maxDelayMs;
+}
+
+void AsyncHTTP::setFollowRedirects(uint8_t maxHops, bool allowInsecure) {
+  _maxRedirects     = maxHops;
+  _redirectInsecure = allowInsecure;
+}
+
+void AsyncHTTP::setCircuitBreaker(uint8_t threshold, unsigned long cooldownMs) {
+  _breakerThreshold = threshold;
+  _breakerCooldown  = cooldownMs;
+  for (uint8_t i = 0; i < ASYNC_HTTP_BREAKER_HOSTS; i++) {
+    _breakers[i] = AsyncHTTPBreaker();
+  }
+}
+
+void AsyncHTTP::setPipelining(bool enable, uint8_t depth) {
+  if (enable) {
+    _keepAlive     = true;
+    _pipelineDepth = constrain(depth, 1, ASYNC_HTTP_PIPELINE_DEPTH);
+  } else {
+    _pipelineDepth = 0;
+  }
+}
+
+// ===========================================================================
+// update()  – MUST be called in loop()
+// ===========================================================================
+
+void AsyncHTTP::update() {
+#if ASYNC_HTTP_SELECT
+  _pollSockets();
+#endif
+  // Slots freed or started by callbacks are seen as the walk goes on
+  for (int8_t i = _nextActive(0); i >= 0; i = _nextActive(i + 1)) {
+    _processSlot(_requests[i]);
+  }
+  if (_keepAlive) _expireIdleConnections();
+  if (_batches) _pumpBatches();
+}
+
+uint8_t AsyncHTTP::pending() const {
+  return _activeCount;
+}
+
+void AsyncHTTP::abort(int requestId) {
+  int8_t slot = _slotFor(requestId);
+  if (slot < 0) return;                 // finished (or never started)
+  if (_requests[slot].group == slot) {
+    // The id of a parallel download stands for all of its parts
+    for (int8_t i = _nextActive(0); i >= 0; i = _nextActive(i + 1)) {
+      if (i != slot && _requests[i].group == slot) _abortSlot(i);
+    }
+  }
+  _abortSlot(slot);
+}
+
+bool AsyncHTTP::setCancelToken(int requestId, AsyncHTTPCancelToken& token) {
+  int8_t slot = _slotFor(requestId);
+  if (slot < 0 || (token._head && token._http != this)) return false;
+  AsyncHTTPRequest& req = _requests[slot];
+  if (req.token == &token) return true;
+  req.unlinkToken();
+  req.token     = &token;
+  req.tokenNext = token._head;
+  if (token._head) token._head->tokenPrev = &req;
+  token._head   = &req;
+  token._http   = this;
+  token._count++;
+  return true;
+}
+
+void AsyncHTTPCancelToken::cancel() {
+  while (_head) {
+    AsyncHTTPRequest* req = _head;
+    _http->abort(req->id);              // unlinks it, with any group parts
+    if (_head == req) req->unlinkToken();
+  }
+}
+
+void AsyncHTTP::_abortSlot(int8_t i) {
+  AsyncHTTPRequest& req = _requests[i];
+  if (req.active && req.conn >= 0) {
+    // Other pipelined requests on this socket are re-sent elsewhere
+    _closeConnection(req.conn, false, i);
+  }
+  req.reset();
+  _releaseSlot(req);
+}
+
+void AsyncHTTP::abort(AsyncHTTPBatch& batch) {
+  if (batch._http != this) return;
+  AsyncHTTPBatch** p = &_batches;
+  while (*p != &batch) p = &(*p)->_next;
+  *p = batch._next;
+  batch._next = nullptr;
+  batch._http = nullptr;
+  _cancelBatch(batch);
+}
+
+void AsyncHTTP::abortAll() {
+  while (_batches) abort(*_batches);
+  for (int8_t i = _nextActive(0); i >= 0; i = _nextActive(i + 1)) {
+    _abortSlot(i);
+  }
+  for (int8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
+    if (_conns[i].open || _conns[i].client) _closeConnection(i, false, -1);
+  }
+}
+
+// ===========================================================================
+// Internal: allocate a slot
+// ===========================================================================
+
+// All slots idle: the free list runs 0, 1, 2, … so requests fill the pool
+// from the front as before
+void AsyncHTTP::_initSlots() {
+  for (int8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
+    _requests[i].slot     = i;
+    _requests[i].nextFree = (i + 1 < ASYNC_HTTP_MAX_REQUESTS) ? i + 1 : -1;
+  }
+  for (uint8_t w = 0; w < ASYNC_HTTP_SLOT_WORDS; w++) _activeSlots[w] = 0;
+  _activeCount = 0;
+  _freeHead    = 0;
+}
+
+// The head of the free list; it stays there until _startSlot() takes it,
+// so an API call that fails on the way needs no clean-up
+int AsyncHTTP::_allocSlot() {
+  int8_t i = _freeHead;
+  if (i < 0) return -1;
+  _requests[i].reset();
+  _sequence = (_sequence + 1) & 0x7FFFFF;   // ids stay positive
+  if (_sequence == 0) _sequence = 1;
+  _requests[i].id = (int)(_sequence << 8 | i);
+  return i;
+}
+
+// A request has ended: clear its bit and put the slot back on the free list
+void AsyncHTTP::_releaseSlot(AsyncHTTPRequest& req) {
+  req.active = false;
+  uint32_t  bit  = 1UL << (req.slot % 32);
+  uint32_t& word = _activeSlots[req.slot / 32];
+  if (!(word & bit)) return;            // never started or already released
+  word        &= ~bit;
+  _activeCount--;
+  req.nextFree = _freeHead;
+  _freeHead    = req.slot;
+}
+
+// First active slot at or after `from`, -1 if none
+int8_t AsyncHTTP::_nextActive(int8_t from) const {
+  for (uint8_t w = from / 32; w < ASYNC_HTTP_SLOT_WORDS; w++) {
+    uint32_t bits = _activeSlots[w];
+    if (w == from / 32) bits &= 0xFFFFFFFFUL << (from % 32);
+    if (bits) return (int8_t)(w * 32 + __builtin_ctzl(bits));
+  }
+  return -1;
+}
+
+// Slot of a running request, -1 for an error code or a stale id
+int8_t AsyncHTTP::_slotFor(int requestId) const {
+  if (requestId < 0) return -1;
+  int slot = requestId & 0xFF;
+  if (slot >= ASYNC_HTTP_MAX_REQUESTS) return -1;
+  const AsyncHTTPRequest& req = _requests[slot];
+  return (req.active && req.id == requestId) ? (int8_t)slot : -1;
+}
+
+// ===========================================================================
+// Internal: attach a callback to an identical in-flight GET
+// ===========================================================================
+
+int AsyncHTTP::_joinInFlight(const String& url,
+                             AsyncHTTPRequest::ResponseCallback onResponse,
+                             void* userData) {
+  AsyncHTTPUrl u;
+  if (!u.parse(url.c_str()) || u.userinfo.off) return -1;
+
+  // Same normalisation as _parseUrl(): an empty path becomes "/"
+  const char* s      = url.c_str();
+  const char* target = s + u.target.off;
+  bool        slash  = u.target.len == 0 || *target == '?';
+
+  for (int8_t i = _nextActive(0); i >= 0; i = _nextActive(i + 1)) {
+    AsyncHTTPRequest& req = _requests[i];
+    if (req.method != HTTP_GET || req.tmpl || req.onDataCb ||
+        req.events || req.ws || req.longPoll ||
+#if ASYNC_HTTP_JSON
+        req.jsonState != AsyncHTTPRequest::JSON_OFF ||
+#endif
+        req.state == STATE_COMPLETE || req.state == STATE_ERROR ||
+        req.waiterCount >= ASYNC_HTTP_COALESCE_WAITERS) {
+      continue;
+    }
+    if (req.tls != u.tls || req.port != u.port ||
+        req.host.length() != u.host.len ||
+        strncasecmp(req.host.c_str(), s + u.host.off, u.host.len) != 0) {
+      continue;
+    }
+    const char* path = req.path.c_str();
+    if (slash) {
+      if (*path != '/') continue;
+      path++;
+    }
+    if (strlen(path) != u.target.len ||
+        strncmp(path, target, u.target.len) != 0) {
+      continue;
+    }
+
+    req.waiters[req.waiterCount].cb   = onResponse;
+    req.waiters[req.waiterCount].data = userData;
+    req.waiterCount++;
+    return req.id;
+  }
+  return -1;
+}
+
+// ===========================================================================
+// AsyncHTTPUrl – single-pass URL parser (no heap allocation)
+// ===========================================================================
+
+static bool _isHex(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+         (c >= 'A' && c <= 'F');
+}
+
+// Characters that may never appear in a request target / authority
+static bool _isBadUrlChar(char c) {
+  return (unsigned char)c <= 0x20 || c == 0x7F || c == '"' || c == '<' ||
+         c == '>' || c == '\\' || c == '^' || c == '`' || c == '{' ||
+         c == '|' || c == '}';
+}
+
+bool AsyncHTTPUrl::parse(const char* url) {
+  *this = AsyncHTTPUrl();
+  if (!url) return false;
+
+  size_t i;
+  if (strncasecmp(url, "https://", 8) == 0) {
+    tls = true;
+    i   = 8;
+  } else if (strncasecmp(url, "http://", 7) == 0) {
+    i   = 7;
+  } else {
+    return false;  // unsupported scheme
+  }
+
+  // ---- Authority: up to the first '/', '?', '#' or end ----
+  size_t authStart = i;
+  size_t at        = 0;        // position of the last '@' (0 = none)
+  for (; url[i] != '\0' && url[i] != '/' && url[i] != '?' && url[i] != '#';
+       i++) {
+    char c = url[i];
+    if (i > 0xFFFF || _isBadUrlChar(c)) return false;
+    if (c == '@') at = i;
+  }
+  size_t authEnd = i;
+
+  // ---- Userinfo (percent-encoding allowed) ----
+  size_t hostStart = authStart;
+  if (at) {
+    for (size_t k = authStart; k < at; k++) {
+      if (url[k] == '%') {
+        if (k + 2 >= at || !_isHex(url[k + 1]) || !_isHex(url[k + 2])) {
+          return false;
+        }
+        k += 2;
+      }
+    }
+    userinfo.off = (uint16_t)authStart;
+    userinfo.len = (uint16_t)(at - authStart);
+    hostStart    = at + 1;
+  }
+
+  // ---- Host: reg-name, IPv4 or [IPv6] ----
+  size_t k = hostStart;
+  if (url[k] == '[') {
+    ipv6 = true;
+    for (k++; k < authEnd && url[k] != ']'; k++) {
+      char c = url[k];
+      if (!_isHex(c) && c != ':' && c != '.') return false;
+    }
+    if (k >= authEnd) return false;  // unterminated '['
+    host.off = (uint16_t)(hostStart + 1);
+    host.len = (uint16_t)(k - hostStart - 1);
+    k++;                             // skip ']'
+  } else {
+    for (; k < authEnd && url[k] != ':'; k++) {
+      char c = url[k];
+      if (c == '%' || c == '[' || c == ']') return false;
+    }
+    host.off = (uint16_t)hostStart;
+    host.len = (uint16_t)(k - hostStart);
+  }
+  if (host.len == 0) return false;
+
+  // ---- Port: 1..65535, empty means default ----
+  port = tls ? 443 : 80;
+  if (k < authEnd) {
+    if (url[k] != ':') return false;
+    if (k + 1 < authEnd) {
+      uint32_t p = 0;
+      for (k++; k < authEnd; k++) {
+        char c = url[k];
+        if (c < '0' || c > '9') return false;
+        p = p * 10 + (uint32_t)(c - '0');
+        if (p > 65535) return false;
+      }
+      if (p == 0) return false;
+      port = (uint16_t)p;
+    }
+  }
+
+  // ---- Path + query (fragment is dropped) ----
+  size_t targetStart = authEnd;
+  for (; url[i] != '\0' && url[i] != '#'; i++) {
+    char c = url[i];
+    if (i > 0xFFFF) return false;
+    if (_isBadUrlChar(c)) return false;
+    if (c == '%') {
+      if (!_isHex(url[i + 1]) || !_isHex(url[i + 2])) return false;
+      i += 2;
+    } else if (c == '?' && query.off == 0) {
+      query.off = (uint16_t)(i + 1);
+    }
+  }
+  target.off = (uint16_t)targetStart;
+  target.len = (uint16_t)(i - targetStart);
+  if (query.off) query.len = (uint16_t)(i - query.off);
+
+  return true;
+}
+
+// ===========================================================================
+// Internal: parse URL into the slot's String fields
+// ===========================================================================
+
+bool AsyncHTTP::_parseUrl(const String& url, String& host, uint16_t& port,
+                          String& path, bool& tls) {
+  AsyncHTTPUrl u;
+  if (!u.parse(url.c_str())) return false;
+  // No Authorization header is derived from user:pass@ – refuse the URL
+  // rather than drop the credentials silently
+  if (u.userinfo.off) return false;
+
+  const char* s = url.c_str();
+  tls  = u.tls;
+  port = u.port;
+
+  host = "";
+  host.concat(s + u.host.off, u.host.len);
+
+  path = "";
+  if (u.target.len == 0 || s[u.target.off] == '?') {
+    path += '/';
+  }
+  path.concat(s + u.target.off, u.target.len);
+
+  return true;
+}
+
+// ===========================================================================
+// Internal: build the static part of the HTTP request header
+// (Content-Length and Connection are appended while sending)
+// ===========================================================================
+
+void AsyncHTTP::_buildRequestHeader(String& h, AsyncHTTPMethod method,
+                                     const String& host, uint16_t port,
+                                     bool tls, const String& path,
+                                     const String& contentType,
+                                     bool identity) {
+  static const char* methodNames[] = {
+    "GET", "POST", "PUT", "PATCH", "DELETE", "HEAD"
+  };
+
+  h = "";
+  h.reserve(256);
+
+  // Request line
+  h += methodNames[(int)method];
+  h += ' ';
+  h += path;
+  h += F(" HTTP/1.1\r\n");
+
+  // Host header
+  h += F("Host: ");
+  if (host.indexOf(':') >= 0) {
+    h += '[';                    // IPv6 literal
+    h += host;
+    h += ']';
+  } else {
+    h += host;
+  }
+  if ((tls && port != 443) || (!tls && port != 80)) {
+    h += ':';
+    h += String(port);
+  }
+  h += F("\r\n");
+
+  // Default headers
+  if (_defaultHeaders.length() > 0) {
+    h += _defaultHeaders;
+  }
+
+  // Compressed responses are decoded transparently (not for downloads:
+  // byte ranges of an encoded body cannot be resumed)
+  if (_decompress && !identity) {
+    h += F("Accept-Encoding: gzip, deflate\r\n");
+  }
+
+  // Content-Type
+  if (contentType.length() > 0) {
+    h += F("Content-Type: ");
+    h += contentType;
+    h += F("\r\n");
+  }
+}
+
+// ===========================================================================
+// Internal: write the request (header block, per-request tail and body)
+// ===========================================================================
+
+struct ChunkWriter {
+  Client* client;
+  size_t  written;
+};
+
+// Deflate sink: every piece of compressed output becomes one HTTP chunk
+static void _chunkSink(void* ctx, const uint8_t* data, size_t len) {
+  ChunkWriter* w = static_cast<ChunkWriter*>(ctx);
+  char size[8];
+  snprintf(size, sizeof(size), "%x\r\n", (unsigned)len);
+  w->written += w->client->print(size);
+  w->written += w->client->write(data, len);
+  w->written += w->client->print(F("\r\n"));
+}
+
+#if ASYNC_HTTP_JSON
+// serializeJson() target: collects the output into writes of
+// ASYNC_HTTP_JSON_WRITE_BUF bytes to the socket, or to the deflater
+class JsonBodyWriter : public Print {
+public:
+  JsonBodyWriter(Client* client, AsyncHTTPDeflate* gz)
+    : _client(client), _gz(gz) {}
+
+  size_t write(uint8_t c) override {
+    if (_len == sizeof(_buf)) push();
+    _buf[_len++] = c;
+    return 1;
+  }
+
+  void push() {
+    if (_gz) {
+      _gz->write(_buf, _len);
+    } else if (_len > 0) {
+      written += _client->write(_buf, _len);
+    }
+    _len = 0;
+  }
+
+  size_t written = 0;
+
+private:
+  Client*           _client;
+  AsyncHTTPDeflate* _gz;
+  uint8_t           _buf[ASYNC_HTTP_JSON_WRITE_BUF];
+  size_t            _len = 0;
+};
+#endif
+
+// Returns the number of bytes written (0 = the socket refused everything)
+size_t AsyncHTTP::_sendRequest(AsyncHTTPRequest& req) {
+  size_t written = req.client->print(req.tmpl ? req.tmpl->_header
+                                              : req.requestHeaders);
+
+  // Large bodies are gzip-compressed on the fly; the compressed length is
+  // not known up front, so they go out with chunked transfer-coding
+#if ASYNC_HTTP_JSON
+  size_t bodyLen = req.jsonBody ? measureJson(*req.jsonBody)
+                                : req.requestBody.length();
+#else
+  size_t bodyLen = req.requestBody.length();
+#endif
+  if (req.multipart) {                  // body follows in STATE_UPLOADING
+    bodyLen = (size_t)req.multipart->contentLength();
+  }
+  ChunkWriter      out = { req.client, 0 };
+  AsyncHTTPDeflate* gz = nullptr;
+  if (_compress && !req.multipart && bodyLen >= ASYNC_HTTP_COMPRESS_MIN_SIZE) {
+    gz = new AsyncHTTPDeflate();
+    if (gz && !gz->begin(_deflateWindow, _chunkSink, &out)) {
+      delete gz;                        // not enough RAM – send as is
+      gz = nullptr;
+    }
+  }
+
+  // Downloads ask for the bytes still missing
+  if (req.onDataCb && (req.rangeNext > 0 || req.rangeEnd >= 0)) {
+    char range[48];                     // room for a 64-bit long end
+    if (req.rangeEnd >= 0) {
+      snprintf(range, sizeof(range), "Range: bytes=%lu-%ld\r\n",
+               (unsigned long)req.rangeNext, req.rangeEnd);
+    } else {
+      snprintf(range, sizeof(range), "Range: bytes=%lu-\r\n",
+               (unsigned long)req.rangeNext);
+    }
+    written += req.client->print(range);
+    if (req.ifRange.length() > 0) {
+      written += req.client->print(F("If-Range: "));
+      written += req.client->print(req.ifRange);
+      written += req.client->print(F("\r\n"));
+    }
+  }
+
+  // Event streams resume after the last event received
+  if (req.events) {
+    written += req.client->print(
+        F("Accept: text/event-stream\r\nCache-Control: no-cache\r\n"));
+    if (req.events->lastId()[0] != '\0') {
+      written += req.client->print(F("Last-Event-ID: "));
+      written += req.client->print(req.events->lastId());
+      written += req.client->print(F("\r\n"));
+    }
+  }
+
+  // WebSocket handshake (a new key for every attempt)
+  if (req.ws) {
+    written += req.client->print(
+        F("Upgrade: websocket\r\nSec-WebSocket-Version: 13\r\n"
+          "Sec-WebSocket-Key: "));
+    written += req.client->print(req.ws->_newKey());
+    written += req.client->print(F("\r\n"));
+  }
+
+  // Per-request tail: Content-Length / Content-Encoding + Connection
+  char tail[96];
+  const char* connHdr = req.ws ? "Upgrade"
+                      : (_keepAlive || req.longPoll) ? "keep-alive" : "close";
+  if (gz) {
+    snprintf(tail, sizeof(tail),
+             "Content-Encoding: gzip\r\nTransfer-Encoding: chunked\r\n"
+             "Connection: %s\r\n\r\n", connHdr);
+  } else if (bodyLen > 0) {
+    snprintf(tail, sizeof(tail),
+             "Content-Length: %u\r\nConnection: %s\r\n\r\n",
+             (unsigned)bodyLen, connHdr);
+  } else {
+    snprintf(tail, sizeof(tail), "Connection: %s\r\n\r\n", connHdr);
+  }
+  written += req.client->print(tail);
+
+#if ASYNC_HTTP_JSON
+  if (req.jsonBody && bodyLen > 0) {
+    JsonBodyWriter body(req.client, gz);
+    serializeJson(*req.jsonBody, body);
+    body.push();
+    written += body.written;
+  } else
+#endif
+  if (gz) {
+    gz->write((const uint8_t*)req.requestBody.c_str(), bodyLen);
+  } else if (bodyLen > 0 && !req.multipart) {
+    written += req.client->print(req.requestBody);
+  }
+  if (gz) {
+    gz->finish();
+    delete gz;
+    written += out.written;
+    written += req.client->print(F("0\r\n\r\n"));
+  }
+  return written;
+}
+
+// One piece of a multipart body per update(); like downloads, uploads only
+// time out when no progress is made
+void AsyncHTTP::_sendUpload(AsyncHTTPRequest& req) {
+  AsyncHTTPMultipart* form = req.multipart;
+  uint8_t buf[ASYNC_HTTP_UPLOAD_CHUNK];
+  size_t  n = form->read(buf, sizeof(buf));
+  if (n > 0) {
+    if (req.client->write(buf, n) != n) {
+      _finishWithError(req, ASYNC_HTTP_ERR_SEND_FAIL, F("Send failed"));
+      return;
+    }
+    req.startTime = millis();
+  }
+  if (!form->done()) return;
+  req.state = STATE_RECEIVING_HEADERS;
+}
+
+// ===========================================================================
+// Internal: response header parsing
+// ===========================================================================
+
+// Strict Content-Length: digits only, no sign, must fit in an int.
+static bool _parseContentLength(const String& value, int& out) {
+  if (value.length() == 0) return false;
+  long n = 0;
+  for (unsigned int i = 0; i < value.length(); i++) {
+    char c = value[i];
+    if (c < '0' || c > '9') return false;
+    n = n * 10 + (c - '0');
+    if (n > 0x7FFFFFFFL) return false;
+  }
+  out = (int)n;
+  return true;
+}
+
+// Parse one complete line held in req._headerLineBuf (CR/LF stripped).
+// Returns false (after finishing the request with an error) on a protocol
+// violation.
+bool AsyncHTTP::_parseHeaderLine(AsyncHTTPRequest& req) {
+  const String& line = req._headerLineBuf;
+
+  // Status line:  "HTTP/1.x NNN reason"
+  if (req.response._statusCode == 0) {
+    if (!line.startsWith("HTTP/1.") || line.length() < 12 ||
+        line[8] != ' ' || !isdigit((unsigned char)line[9]) ||
+        !isdigit((unsigned char)line[10]) ||
+        !isdigit((unsigned char)line[11]) ||
+        (line.length() > 12 && line[12] != ' ')) {
+      _finishWithError(req, ASYNC_HTTP_ERR_PARSE_FAIL,
+                       F("Malformed status line"));
+      return false;
+    }
+    int code = (line[9] - '0') * 100 + (line[10] - '0') * 10 + (line[11] - '0');
+    if (code < 100) {
+      _finishWithError(req, ASYNC_HTTP_ERR_PARSE_FAIL,
+                       F("Malformed status line"));
+      return false;
+    }
+    req.response._statusCode = code;
+    req.connClose = line[7] == '0';   // HTTP/1.0 closes unless told otherwise
+    return true;
+  }
+
+  // Header line:  "Name: Value"
+  int colonIdx = line.indexOf(':');
+  if (colonIdx <= 0) return true;  // ignore junk / obsolete line folding
+
+  String name  = line.substring(0, colonIdx);
+  String value = line.substring(colonIdx + 1);
+  name.trim();
+  value.trim();
+
+  // Track Content-Length
+  if (name.equalsIgnoreCase("Content-Length")) {
+    int len;
+    if (!_parseContentLength(value, len) ||
+        (req.response._contentLength >= 0 &&
+         req.response._contentLength != len)) {
+      _finishWithError(req, ASYNC_HTTP_ERR_PARSE_FAIL,
+                       F("Invalid Content-Length"));
+      return false;
+    }
+    req.response._contentLength = len;
+    req.remainingBytes = len;
+  }
+  // Track Transfer-Encoding: chunked must be the final coding, anything
+  // else is delimited by the server closing the connection
+  if (name.equalsIgnoreCase("Transfer-Encoding")) {
+    String v = value;
+    v.toLowerCase();
+    if (v.endsWith("chunked")) {
+      req.chunked = true;
+    } else {
+      req.connClose = true;
+    }
+  }
+  // Track Connection: close / keep-alive
+  if (name.equalsIgnoreCase("Connection")) {
+    String v = value;
+    v.toLowerCase();
+    if (v.indexOf("close") >= 0) {
+      req.connClose = true;
+    } else if (v.indexOf("keep-alive") >= 0) {
+      req.connClose = false;
+    }
+  }
+
+  req.response._addHeader(name, value);
+  return true;
+}
+
+// ===========================================================================
+// Internal: response body decoding
+// ===========================================================================
+
+// Message-length rules of RFC 7230 §3.3.3, applied once the header block
+// is complete. Returns true if the response has no body at all, so it can
+// finish without waiting for more bytes or for the server to close.
+bool AsyncHTTP::_bodyIsEmpty(AsyncHTTPRequest& req) {
+  int code = req.response._statusCode;
+
+  // 101 Switching Protocols: the socket no longer speaks HTTP
+  if (code == 101) {
+    req.connClose = true;
+    return true;
+  }
+  // HEAD responses and 1xx/204/304 never carry a body, whatever the
+  // Content-Length / Transfer-Encoding headers say
+  if (req.method == HTTP_HEAD || code < 200 || code == 204 || code == 304) {
+    return true;
+  }
+  // Transfer-Encoding overrides Content-Length; a message carrying both
+  // is suspect, so do not reuse the socket afterwards
+  if (req.chunked) {
+    if (req.remainingBytes >= 0) req.connClose = true;
+    req.remainingBytes = -1;
+    return false;
+  }
+  return req.remainingBytes == 0;
+}
+
+// Stops the decoder once a callback has aborted the request
+static bool _inflateSink(void* ctx, const uint8_t* data, size_t len) {
+  AsyncHTTPRequest& req = *static_cast<AsyncHTTPRequest*>(ctx);
+  req.storeBody(data, len);
+  return req.active && req.inflate;
+}
+
+// Set up the content-coding stage once the headers are known
+bool AsyncHTTP::_startBody(AsyncHTTPRequest& req) {
+  if (!_decompress) return true;
+
+  String enc = req.response.header("Content-Encoding");
+  enc.toLowerCase();
+  AsyncHTTPInflate::Format fmt;
+  if (enc == "gzip" || enc == "x-gzip") {
+    fmt = AsyncHTTPInflate::FORMAT_GZIP;
+  } else if (enc == "deflate") {
+    fmt = AsyncHTTPInflate::FORMAT_DEFLATE;
+  } else {
+    return true;                      // identity (or unsupported) – as is
+  }
+
+  req.inflate = new AsyncHTTPInflate();
+  if (!req.inflate || !req.inflate->begin(fmt, _inflateWindow,
+                                          _inflateSink, &req)) {
+    _finishWithError(req, ASYNC_HTTP_ERR_NO_MEMORY,
+                     F("Out of memory for decompression"));
+    return false;
+  }
+  return true;
+}
+
+// Framing decoder → content decoder → body
+bool AsyncHTTP::_appendBody(AsyncHTTPRequest& req, char c) {
+  if (req.inflate) return req.inflateInput((const uint8_t*)&c, 1);
+  req.storeBody((const uint8_t*)&c, 1);
+  return true;
+}
+
+// End of the message: a compressed body must also have reached the end of
+// its stream (unless it was cut short by ASYNC_HTTP_BODY_BUF_SIZE)
+void AsyncHTTP::_completeBody(AsyncHTTPRequest& req, bool framed) {
+  // A download must end exactly at the last byte announced for it
+  if (req.streamBody) {
+    req.flushBody();
+    if (!req.active) return;            // aborted from onData
+    if (req.rangeEnd >= 0 && req.rangeNext != (uint32_t)req.rangeEnd + 1) {
+      _finishWithError(req, ASYNC_HTTP_ERR_INCOMPLETE,
+                       F("Download interrupted"));
+      return;
+    }
+  }
+  // The server closed before the length it announced was reached
+  if (!framed && (req.chunked || req.remainingBytes > 0)) {
+    _finishWithError(req, ASYNC_HTTP_ERR_INCOMPLETE,
+                     F("Connection closed mid-body"));
+    return;
+  }
+  if (req.inflate) {
+    req.inflateInput(nullptr, 0);
+    if (!req.active) return;            // aborted from onData
+    if (!req.inflate->finished() &&
+        (int)req.response._body.length() < ASYNC_HTTP_BODY_BUF_SIZE) {
+      _finishWithError(req, ASYNC_HTTP_ERR_PARSE_FAIL,
+                       F("Truncated compressed body"));
+      return;
+    }
+  }
+  _finishWithResponse(req, framed);
+}
+
+// One raw body byte through the framing and content decoders. Returns 1 at
+// the end of the message, -1 once the request has failed, 0 otherwise.
+int AsyncHTTP::_bodyByte(AsyncHTTPRequest& req, char c) {
+  if (req.chunked) {
+    int rc = _feedChunked(req, c);
+    if (rc < 0) {
+      if (req.inflate && req.inflate->failed()) {
+        _finishWithError(req, ASYNC_HTTP_ERR_PARSE_FAIL,
+                         F("Decompression failed"));
+      } else {
+        _finishWithError(req, ASYNC_HTTP_ERR_PARSE_FAIL,
+                         F("Invalid chunked encoding"));
+      }
+    }
+    return rc;
+  }
+  if (!_appendBody(req, c)) {
+    _finishWithError(req, ASYNC_HTTP_ERR_PARSE_FAIL,
+                     F("Decompression failed"));
+    return -1;
+  }
+  if (req.remainingBytes > 0 && --req.remainingBytes == 0) return 1;
+  return 0;
+}
+
+// Incremental chunked transfer-coding decoder
+enum {
+  CHUNK_SIZE = 0,      // first hex digit of the chunk-size line
+  CHUNK_SIZE_MORE,     // further hex digits
+  CHUNK_EXT,           // chunk extension / CR – skip to LF
+  CHUNK_DATA,
+  CHUNK_DATA_CR,       // CRLF after chunk data
+  CHUNK_DATA_LF,
+  CHUNK_TRAILER,       // start of a trailer line (empty line ends the body)
+  CHUNK_TRAILER_LINE,
+  CHUNK_TRAILER_LF
+};
+
+static int _hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Returns 1 once the terminating chunk and trailer are consumed,
+// -1 on malformed framing, 0 otherwise.
+int AsyncHTTP::_feedChunked(AsyncHTTPRequest& req, char c) {
+  switch (req.chunkState) {
+    case CHUNK_SIZE:
+    case CHUNK_SIZE_MORE: {
+      int v = _hexValue(c);
+      if (v >= 0) {
+        if (req.chunkRemaining > 0x07FFFFFFL) return -1;
+        req.chunkRemaining = req.chunkRemaining * 16 + v;
+        req.chunkState = CHUNK_SIZE_MORE;
+        return 0;
+      }
+      if (req.chunkState == CHUNK_SIZE) return -1;
+      if (c == '\n') break;                 // bare LF ends the size line
+      req.chunkState = CHUNK_EXT;           // ';', whitespace or CR
+      return 0;
+    }
+    case CHUNK_EXT:
+      if (c != '\n') return 0;
+      break;
+
+    case CHUNK_DATA:
+      if (!_appendBody(req, c)) return -1;
+      if (--req.chunkRemaining == 0) req.chunkState = CHUNK_DATA_CR;
+      return 0;
+
+    case CHUNK_DATA_CR:
+      if (c == '\r') { req.chunkState = CHUNK_DATA_LF; return 0; }
+      if (c == '\n') { req.chunkState = CHUNK_SIZE;    return 0; }
+      return -1;
+
+    case CHUNK_DATA_LF:
+      if (c != '\n') return -1;
+      req.chunkState = CHUNK_SIZE;
+      return 0;
+
+    case CHUNK_TRAILER:
+      if (c == '\n') return 1;
+      req.chunkState = (c == '\r') ? CHUNK_TRAILER_LF : CHUNK_TRAILER_LINE;
+      return 0;
+
+    case CHUNK_TRAILER_LINE:
+      if (c == '\n') req.chunkState = CHUNK_TRAILER;
+      return 0;
+
+    case CHUNK_TRAILER_LF:
+      if (c == '\n') return 1;
+      req.chunkState = CHUNK_TRAILER_LINE;
+      return 0;
+
+    default:
+      return -1;
+  }
+
+  // End of a chunk-size line
+  req.chunkState = (req.chunkRemaining == 0) ? CHUNK_TRAILER : CHUNK_DATA;
+  return 0;
+}
+
+// ===========================================================================
+// Internal: per-slot state machine   (called from update())
+// ===========================================================================
+
+void AsyncHTTP::_processSlot(AsyncHTTPRequest& req) {
+  // ---- Fresh cache entry: answer without touching the network ----
+  if (req.cacheHit) {
+    AsyncHTTPCacheEntry entry;
+    req.cacheHit = _cache && _cache->load(req.cacheKey, entry);
+    if (req.cacheHit) {
+      _fillFromCache(req, entry);
+      _finishWithResponse(req);
+      return;
+    }
+    // Evicted in the meantime – fetch it after all
+  }
+
+  // ---- Retry back-off ----
+  if (req.state == STATE_BACKOFF) {
+    if ((long)(millis() - req.retryAt) < 0) return;
+    req.state     = STATE_CONNECTING;
+    req.startTime = millis();           // every attempt gets the full timeout
+  }
+
+  // ---- Timeout check (an open WebSocket pings instead) ----
+  if (req.state != STATE_COMPLETE && req.state != STATE_ERROR &&
+      req.state != STATE_IDLE && req.state != STATE_WEBSOCKET) {
+    if (millis() - req.startTime > req.timeoutMs) {
+      _finishWithError(req, ASYNC_HTTP_ERR_TIMEOUT, F("Request timed out"));
+      return;
+    }
+  }
+
+  // Pipelined requests wait until every earlier response has been read
+  if ((req.state == STATE_RECEIVING_HEADERS ||
+       req.state == STATE_RECEIVING_BODY) &&
+      _conns[req.conn].head != _slotOf(req)) {
+    return;
+  }
+
+  switch (req.state) {
+
+    // ---------------------------------------------------------------
+    case STATE_CONNECTING: {
+      // Pick a socket: an idle keep-alive one to the same host, a queue
+      // position on a pipelined one, or a free one
+      if (req.conn < 0) {
+        if (!_breakerAllow(req)) {
+          _finishWithError(req, ASYNC_HTTP_ERR_CIRCUIT_OPEN,
+                           F("Circuit open"));
+          return;
+        }
+        if (!_rateAllow(req)) {         // a retry or redirect
+          req.startTime = millis();     // deferred, not yet timing out
+          break;
+        }
+        if (!_attachConnection(req)) {
+          break;  // every socket is busy – try again on the next update()
+        }
+      }
+      AsyncHTTPConnection& conn = _conns[req.conn];
+      if (conn.open) {
+        req.state = STATE_SENDING;
+        break;
+      }
+
+      // Attempt connect (on most Arduino cores this is blocking the first
+      // time, but returns quickly on subsequent calls if already connected)
+      int rc;
+#if ASYNC_HTTP_SSL_SUPPORT
+      if (req.tls) {
+  #if defined(ESP32)
+        WiFiClientSecure* sc = static_cast<WiFiClientSecure*>(req.client);
+        if (_insecure) sc->setInsecure();
+  #endif
+      }
+#endif
+      rc = req.client->connect(req.connectHost(), req.port);
       if (rc) {
+        conn.open = true;
         req.state = STATE_SENDING;
       } else {
         // Connection failed immediately
@@ -475,195 +1772,1334 @@ void AsyncHTTP::_processSlot(AsyncHTTPRequest& req) {
       break;
     }
 
-    // ---------------------------------------------------------------
-    case STATE_SENDING: {
-      // Send header + body in one go
-      size_t written = req.client->print(req.requestHeaders);
-      if (req.requestBody.length() > 0) {
-        written += req.client->print(req.requestBody);
+    // ---------------------------------------------------------------
+    case STATE_SENDING: {
+      // A Stream part cannot be read a second time
+      if (req.multipart && !req.multipart->rewind()) {
+        _finishWithError(req, ASYNC_HTTP_ERR_SEND_FAIL,
+                         F("Upload stream cannot be re-sent"));
+        return;
+      }
+
+      // Send header + body in one go (a multipart body follows in pieces)
+      size_t written = _sendRequest(req);
+      if (written == 0) {
+        // A reused keep-alive socket may have been closed by the server
+        if (_canResend(req)) {
+          _closeConnection(req.conn, true, -1);
+        } else {
+          _finishWithError(req, ASYNC_HTTP_ERR_SEND_FAIL, F("Send failed"));
+        }
+        return;
+      }
+      if (!_keepAlive && _retryMax <= 1 && _maxRedirects == 0 &&
+          !req.onDataCb && !req.events && !req.longPoll) {
+        req.requestHeaders = ""; // free memory
+        req.requestBody    = "";
+      }
+      req.drained = false;
+      req.state = req.multipart ? STATE_UPLOADING : STATE_RECEIVING_HEADERS;
+      break;
+    }
+
+    // ---------------------------------------------------------------
+    case STATE_UPLOADING:
+      _sendUpload(req);
+      break;
+
+    // ---------------------------------------------------------------
+    case STATE_WEBSOCKET:
+      _processWebSocket(req);
+      break;
+
+    // ---------------------------------------------------------------
+    case STATE_RECEIVING_HEADERS: {
+      if (req.quiet) break;             // nothing new since it was read dry
+      req.drained = false;
+      while (req.client->available()) {
+        char c = (char)req.client->read();
+        req.gotBytes = true;
+
+        if (c == '\n') {
+          // Remove trailing \r
+          if (req._headerLineBuf.endsWith("\r")) {
+            req._headerLineBuf.remove(req._headerLineBuf.length() - 1);
+          }
+
+          if (req._headerLineBuf.length() == 0) {
+            if (req.response._statusCode == 0) {
+              _finishWithError(req, ASYNC_HTTP_ERR_PARSE_FAIL,
+                               F("Missing status line"));
+              return;
+            }
+            // Interim 1xx response (e.g. 100 Continue): discard it, the
+            // final response follows on the same socket
+            int code = req.response._statusCode;
+            if (code < 200 && code != 101) {
+              req.resetResponse();
+              req.gotBytes = true;
+              continue;
+            }
+
+            // Empty line → headers done
+            req.headersDone = true;
+            if (req.ws) {
+              _startWebSocket(req);
+              return;
+            }
+            if (req.onDataCb && !_startDownload(req)) return;
+            if (req.events) _startEvents(req);
+            if (_bodyIsEmpty(req)) {
+              _finishWithResponse(req, true);
+              return;
+            }
+            if (!_startBody(req)) return;
+            req.state = STATE_RECEIVING_BODY;
+            return;  // will continue reading body on next update()
+          }
+
+          if (!_parseHeaderLine(req)) return;
+          req._headerLineBuf = "";
+        } else if (req._headerLineBuf.length() >= ASYNC_HTTP_HEADER_BUF_SIZE) {
+          _finishWithError(req, ASYNC_HTTP_ERR_PARSE_FAIL,
+                           F("Header line too long"));
+          return;
+        } else {
+          req._headerLineBuf += c;
+        }
+      }
+      req.drained = true;
+
+      // If connection closed before headers finished
+      if (!req.client->connected() && !req.client->available()) {
+        if (req.response._statusCode > 0 && !req.ws) {
+          // We got at least a status code – treat as done, unless the
+          // headers announced a body that never came
+          _completeBody(req, false);
+        } else if (!req.gotBytes && _canResend(req)) {
+          // Keep-alive socket dropped before answering – send again
+          _closeConnection(req.conn, true, -1);
+        } else {
+          _finishWithError(req, ASYNC_HTTP_ERR_PARSE_FAIL,
+                           F("Connection closed during headers"));
+        }
+      }
+      break;
+    }
+
+    // ---------------------------------------------------------------
+    case STATE_RECEIVING_BODY: {
+      if (req.quiet) break;
+      req.drained = false;
+#if ASYNC_HTTP_JSON
+      // JSON response: collect the decoded body, parsed once complete
+      if (req.jsonState == AsyncHTTPRequest::JSON_WANTED &&
+          req.response.isSuccess()) {
+        req.jsonState = AsyncHTTPRequest::JSON_COLLECTING;
+      }
+#endif
+
+      // Read available bytes
+      while (req.client->available()) {
+        int rc = _bodyByte(req, (char)req.client->read());
+        if (rc < 0) return;
+        if (rc > 0) {
+          _completeBody(req, true);
+          return;
+        }
+        if (!req.active) return;        // download aborted from onData
+
+        // Body buffer full – without keep-alive there is no need to drain
+        // the rest of the message
+        if (!_keepAlive && !req.collectsJson() &&
+            (int)req.response._body.length() >= ASYNC_HTTP_BODY_BUF_SIZE) {
+          _finishWithResponse(req);
+          return;
+        }
+      }
+      req.drained = true;
+
+      // Connection closed → done
+      if (!req.client->connected() && !req.client->available()) {
+        _completeBody(req, false);
+      }
+      break;
+    }
+
+    // ---------------------------------------------------------------
+    case STATE_COMPLETE:
+    case STATE_ERROR:
+    case STATE_TIMEOUT:
+    case STATE_IDLE:
+    default:
+      break;
+  }
+}
+
+// ===========================================================================
+// Internal: finish helpers
+// ===========================================================================
+
+void AsyncHTTP::_finishWithError(AsyncHTTPRequest& req, int code,
+                                  const String& msg) {
+  bool transient = code == ASYNC_HTTP_ERR_CONNECT_FAIL ||
+                   code == ASYNC_HTTP_ERR_SEND_FAIL ||
+                   code == ASYNC_HTTP_ERR_TIMEOUT ||
+                   code == ASYNC_HTTP_ERR_INCOMPLETE;
+  if (transient) _breakerRecord(req, true);
+  req.flushBody();                      // bytes received so far are valid
+  if (!req.active) return;              // aborted from onData
+
+  // Event streams are reopened whatever went wrong
+  if (req.events && code != ASYNC_HTTP_ERR_NO_MEMORY) {
+    _reconnectEvents(req, false);
+    return;
+  }
+
+  // Long polls carry on after a failed cycle
+  if (req.longPoll && transient) {
+    _rearmPoll(req, false, ASYNC_HTTP_LONGPOLL_RETRY);
+    return;
+  }
+
+  // Transient failure: nothing reached the server if the connect or the
+  // first write failed, otherwise only idempotent requests are repeated.
+  // Downloads resume from the next missing byte even without setRetry().
+  if ((_retryMax > 1 || req.onDataCb) && transient) {
+    bool safe = code == ASYNC_HTTP_ERR_CONNECT_FAIL ||
+                (code == ASYNC_HTTP_ERR_SEND_FAIL &&
+                 req.state == STATE_SENDING) ||
+                (code == ASYNC_HTTP_ERR_TIMEOUT &&
+                 req.state == STATE_CONNECTING);
+    if (_retry(req, safe, -1, false)) return;
+  }
+
+  req.state = STATE_ERROR;
+  _detachConnection(req, false);
+  req.releaseInflate();
+#if ASYNC_HTTP_JSON
+  delete req.json;
+  req.json = nullptr;
+#endif
+  _finishPart(req, true);
+
+  // Fire per-request or global error callback; callers that joined the
+  // request have no error callback of their own and get the global one
+  if (req.onErrorCb) {
+    req.onErrorCb(code, msg, req.onErrorData);
+  }
+  for (uint8_t i = 0; i < req.waiterCount && _globalErrorCb; i++) {
+    _globalErrorCb(code, msg, req.waiters[i].data);
+  }
+
+  // Cleanup
+  req.requestHeaders = "";
+  req.requestBody    = "";
+  delete req.events;
+  req.events = nullptr;
+  req.unlinkToken();
+  _releaseSlot(req);
+
+  // A WebSocket that never opened is closed as well
+  if (req.ws) {
+    AsyncHTTPWebSocket* ws = req.ws;
+    req.ws = nullptr;
+    ws->_closed(1006, msg.c_str());
+  }
+}
+
+// `framed` – the message end was found from HEAD/Content-Length/chunked
+// framing, so the socket is positioned at the next response and may be kept
+void AsyncHTTP::_finishWithResponse(AsyncHTTPRequest& req, bool framed) {
+  bool reusable = framed && (_keepAlive || req.longPoll) && !req.connClose &&
+                  req.client && req.client->connected();
+
+  // Overloaded / unavailable: 429 and 503 mean the request was not
+  // processed, 502/504 may have reached the origin
+  int code = req.response._statusCode;
+  if (!req.cacheHit) {
+    _breakerRecord(req, code == 502 || code == 503 || code == 504);
+  }
+  if (code >= 301 && code <= 308 && _redirect(req, reusable)) return;
+  if (req.streamEvents) {
+    _reconnectEvents(req, reusable);    // the server ended the stream
+    return;
+  }
+  if (req.longPoll) {
+    _finishPoll(req, reusable);
+    return;
+  }
+  if (_retryMax > 1 && !req.cacheHit &&
+      (code == 429 || code == 502 || code == 503 || code == 504)) {
+    long   delayMs = -1;
+    String after   = req.response.header("Retry-After");
+    after.trim();
+    if (after.length() > 0 && isdigit((unsigned char)after[0])) {
+      // A day is past any back-off cap and keeps the product in range;
+      // the HTTP-date form uses the back-off
+      delayMs = min(after.toInt(), 86400L) * 1000L;
+    }
+    if (_retry(req, code == 429 || code == 503, delayMs, reusable)) return;
+  }
+#if ASYNC_HTTP_JSON
+  if (req.collectsJson() && !_parseJsonBody(req)) return;
+#endif
+
+  req.state = STATE_COMPLETE;
+  _detachConnection(req, reusable);
+  if (req.inflate) {
+    req.inflateInput(nullptr, 0);
+    req.releaseInflate();             // release the window before the callback
+  }
+
+  if (_cache && req.cacheKey.length() > 0 && !req.cacheHit) {
+    _cacheResponse(req);
+  }
+
+  // Fire callback(s) – a parallel download only once, for its last part
+  bool report = _finishPart(req, !req.response.isSuccess());
+  if (req.onResponseCb && report) {
+    req.onResponseCb(req.response, req.onResponseData);
+  }
+  for (uint8_t i = 0; i < req.waiterCount; i++) {
+    if (req.waiters[i].cb) req.waiters[i].cb(req.response, req.waiters[i].data);
+  }
+#if ASYNC_HTTP_JSON
+  if (req.onJsonCb) {
+    JsonDocument empty;                 // error status or empty body
+    req.onJsonCb(req.response, req.json ? *req.json : empty,
+                 req.onResponseData);
+  }
+  delete req.json;
+  req.json = nullptr;
+#endif
+
+  // Cleanup
+  req.requestHeaders = "";
+  req.requestBody    = "";
+  delete req.events;
+  req.events = nullptr;
+  req.unlinkToken();
+  _releaseSlot(req);
+}
+
+#if ASYNC_HTTP_JSON
+// ===========================================================================
+// Internal: JSON responses
+// ===========================================================================
+
+// Parse the collected body of a 2xx JSON response. Returns false if the
+// request was finished with an error instead.
+bool AsyncHTTP::_parseJsonBody(AsyncHTTPRequest& req) {
+  if (req.inflate) req.inflateInput(nullptr, 0);  // last decoded bytes
+  String& body = req.response._body;
+  if (body.length() > ASYNC_HTTP_JSON_BODY_SIZE) {
+    _finishWithError(req, ASYNC_HTTP_ERR_NO_MEMORY, F("JSON body too large"));
+    return false;
+  }
+  req.json = new JsonDocument();
+  if (!req.json) {
+    _finishWithError(req, ASYNC_HTTP_ERR_NO_MEMORY,
+                     F("Out of memory for JSON document"));
+    return false;
+  }
+
+  DeserializationError err = req.jsonFilter
+      ? deserializeJson(*req.json, body.c_str(), body.length(),
+                        DeserializationOption::Filter(*req.jsonFilter))
+      : deserializeJson(*req.json, body.c_str(), body.length());
+  body = "";                            // the document holds its own copy
+  if (err) {
+    _finishWithError(req, ASYNC_HTTP_ERR_PARSE_FAIL,
+                     String(F("Invalid JSON: ")) + err.c_str());
+    return false;
+  }
+  return true;
+}
+#endif
+
+// ===========================================================================
+// Internal: downloads
+// ===========================================================================
+
+// "bytes first-last/total" (total may be "*")
+static bool _parseContentRange(const String& value, uint32_t& first,
+                               uint32_t& last) {
+  if (!value.startsWith("bytes ")) return false;
+  const char* p = value.c_str() + 6;
+  char* end;
+  first = strtoul(p, &end, 10);
+  if (end == p || *end != '-') return false;
+  p = end + 1;
+  last = strtoul(p, &end, 10);
+  return end != p && *end == '/' && last >= first;
+}
+
+// Headers of a download response: a 2xx body is streamed, and a ranged
+// request must get exactly the bytes it asked for. Other statuses are
+// delivered with their (buffered) body.
+bool AsyncHTTP::_startDownload(AsyncHTTPRequest& req) {
+  int code = req.response._statusCode;
+  if (code < 200 || code >= 300) return true;
+
+  if (req.rangeNext > 0 || req.rangeEnd >= 0) {
+    uint32_t first, last;
+    if (code != 206 ||
+        !_parseContentRange(req.response.header("Content-Range"), first, last) ||
+        first != req.rangeNext ||
+        (req.rangeEnd >= 0 && last > (uint32_t)req.rangeEnd)) {
+      // 200 here means If-Range failed: the resource changed under us
+      _finishWithError(req, ASYNC_HTTP_ERR_RANGE, F("Range not honoured"));
+      return false;
+    }
+    if (req.rangeEnd < 0) req.rangeEnd = last;
+  } else if (req.response._contentLength >= 0) {
+    req.rangeEnd = (long)req.response._contentLength - 1;
+  }
+
+  // If-Range needs a strong validator: an ETag, else Last-Modified
+  if (req.ifRange.length() == 0) {
+    String etag = req.response.header("ETag");
+    req.ifRange = etag.startsWith("W/") ? String() : etag;
+    if (req.ifRange.length() == 0) {
+      req.ifRange = req.response.header("Last-Modified");
+    }
+  }
+  req.streamBody = true;
+  return true;
+}
+
+// End of one part of a parallel download. A failed part cancels the
+// others. Returns true if the outcome should be reported (plain requests,
+// failures, the last part to finish).
+bool AsyncHTTP::_finishPart(AsyncHTTPRequest& req, bool failed) {
+  if (req.group < 0) return true;
+  bool last = true;
+  for (int8_t i = _nextActive(0); i >= 0; i = _nextActive(i + 1)) {
+    AsyncHTTPRequest& other = _requests[i];
+    if (&other == &req || other.group != req.group) continue;
+    if (failed) {
+      _abortSlot(i);
+    } else {
+      last = false;
+    }
+  }
+  return last;
+}
+
+// ===========================================================================
+// Internal: Server-Sent Events
+// ===========================================================================
+
+// Headers of an event stream: only a 2xx text/event-stream body is parsed,
+// anything else ends the stream and is delivered to onClose
+void AsyncHTTP::_startEvents(AsyncHTTPRequest& req) {
+  int    code = req.response._statusCode;
+  String type = req.response.header("Content-Type");
+  type.toLowerCase();
+  req.streamEvents = code >= 200 && code < 300 && code != 204 &&
+                     type.startsWith("text/event-stream");
+}
+
+// Reopen the stream after the server's retry: delay (a partly received
+// event is dropped); Last-Event-ID is sent from the parser
+void AsyncHTTP::_reconnectEvents(AsyncHTTPRequest& req, bool reusable) {
+  uint32_t delayMs = req.events->retry();
+  req.events->discard();
+  _detachConnection(req, reusable);
+  req.resetResponse();
+  req.redirects    = 0;
+  req.reissued     = false;
+  req.rateAdmitted = false;
+  req.state   = STATE_BACKOFF;
+  req.retryAt = millis() + (delayMs ? delayMs : ASYNC_HTTP_SSE_RETRY);
+}
+
+// ===========================================================================
+// Internal: long polling
+// ===========================================================================
+
+// Deliver one cycle's response; the slot, its header block and the socket
+// stay with the poll
+void AsyncHTTP::_finishPoll(AsyncHTTPRequest& req, bool reusable) {
+  int  code = req.response._statusCode;
+  bool ok   = (code >= 200 && code < 300) || code == 304;
+  if (req.inflate) {
+    req.inflateInput(nullptr, 0);
+    req.releaseInflate();               // release the window before the callback
+  }
+  req.onResponseCb(req.response, req.onResponseData);
+  if (!req.active) return;              // aborted from the callback
+  _rearmPoll(req, reusable, ok ? 0 : ASYNC_HTTP_LONGPOLL_RETRY);
+}
+
+// Next cycle: a socket left reusable stays attached, so STATE_CONNECTING
+// moves straight on to sending; otherwise a fresh one is taken
+void AsyncHTTP::_rearmPoll(AsyncHTTPRequest& req, bool reusable,
+                           unsigned long delayMs) {
+  if (!reusable) _detachConnection(req, false);
+  req.resetResponse();
+  req.redirects    = 0;
+  req.reissued     = false;
+  req.rateAdmitted = false;
+  if (delayMs > 0) {
+    req.state   = STATE_BACKOFF;
+    req.retryAt = millis() + delayMs;
+  } else {
+    req.state     = STATE_CONNECTING;
+    req.startTime = millis();
+  }
+}
+
+// ===========================================================================
+// Internal: batches
+// ===========================================================================
+
+// Send queued requests of `batch` while slots are free (and its parallel
+// limit allows). Batch requests never join an in-flight GET, since joined
+// callers are not told about errors.
+void AsyncHTTP::_submitBatch(AsyncHTTPBatch& batch) {
+  uint8_t running = 0;
+  for (uint8_t i = 0; i < batch._count; i++) {
+    if (batch._items[i].state == AsyncHTTPBatch::ITEM_RUNNING) running++;
+  }
+  for (uint8_t i = 0; i < batch._count; i++) {
+    AsyncHTTPBatch::Item& it = batch._items[i];
+    if (it.state != AsyncHTTPBatch::ITEM_QUEUED) continue;
+    if ((batch._parallel && running >= batch._parallel) ||
+        pending() >= ASYNC_HTTP_MAX_REQUESTS) {
+      return;
+    }
+    if (_rateLimited(it.url)) continue;   // stays queued for a token
+    int id = _newRequest(it.method, it.url, it.body, it.contentType,
+                         AsyncHTTPBatch::_onResponse, &it);
+    if (id < 0) {
+      it.status = id;
+      it.state  = AsyncHTTPBatch::ITEM_DONE;
+      continue;
+    }
+    AsyncHTTPRequest& req = _requests[_slotFor(id)];
+    it.chainCb      = req.onErrorCb;
+    it.chainData    = req.onErrorData;
+    req.onErrorCb   = AsyncHTTPBatch::_onError;
+    req.onErrorData = &it;
+    it.id    = id;
+    it.state = AsyncHTTPBatch::ITEM_RUNNING;
+    running++;
+  }
+}
+
+// Called from update(): refill the running batches and complete the first
+// finished one (one onDone per update(), as it may start a batch again)
+void AsyncHTTP::_pumpBatches() {
+  for (AsyncHTTPBatch* b = _batches; b; b = b->_next) {
+    bool failed = false;
+    bool done   = true;
+    for (uint8_t i = 0; i < b->_count; i++) {
+      AsyncHTTPBatch::Item& it = b->_items[i];
+      if (it.state == AsyncHTTPBatch::ITEM_RUNNING && _slotFor(it.id) < 0) {
+        it.state = AsyncHTTPBatch::ITEM_DONE;   // aborted by its id
       }
-      if (written == 0) {
-        _finishWithError(req, ASYNC_HTTP_ERR_SEND_FAIL, F("Send failed"));
-        return;
+      if (it.state != AsyncHTTPBatch::ITEM_DONE) {
+        done = false;
+      } else if (!b->succeeded(i)) {
+        failed = true;
       }
-      req.requestHeaders = ""; // free memory
-      req.requestBody    = "";
-      req.state = STATE_RECEIVING_HEADERS;
-      break;
+    }
+    if (!done && !(failed && b->_allOrNothing)) {
+      _submitBatch(*b);
+      continue;
     }
 
-    // ---------------------------------------------------------------
-    case STATE_RECEIVING_HEADERS: {
-      while (req.client->available()) {
-        char c = (char)req.client->read();
+    AsyncHTTPBatch& batch = *b;
+    abort(batch);                       // cancels what is left
+    if (batch._doneCb) batch._doneCb(batch, batch._doneData);
+    return;
+  }
+}
 
-        if (c == '\n') {
-          // Remove trailing \r
-          if (req._headerLineBuf.endsWith("\r")) {
-            req._headerLineBuf.remove(req._headerLineBuf.length() - 1);
-          }
+// Abort the running requests and mark the rest as cancelled (status 0)
+void AsyncHTTP::_cancelBatch(AsyncHTTPBatch& batch) {
+  for (uint8_t i = 0; i < batch._count; i++) {
+    AsyncHTTPBatch::Item& it = batch._items[i];
+    if (it.state == AsyncHTTPBatch::ITEM_RUNNING) abort(it.id);
+    if (it.state != AsyncHTTPBatch::ITEM_DONE) {
+      it.state = AsyncHTTPBatch::ITEM_DONE;
+      it.id    = -1;
+    }
+  }
+}
 
-          if (req._headerLineBuf.length() == 0) {
-            // Empty line → headers done
-            req.headersDone = true;
-            req.state = STATE_RECEIVING_BODY;
-            return;  // will continue reading body on next update()
-          }
+// ===========================================================================
+// Internal: WebSockets
+// ===========================================================================
 
-          // Parse status line
-          if (req.response._statusCode == 0 &&
-              req._headerLineBuf.startsWith("HTTP/")) {
-            int spaceIdx = req._headerLineBuf.indexOf(' ');
-            if (spaceIdx > 0) {
-              req.response._statusCode =
-                req._headerLineBuf.substring(spaceIdx + 1).toInt();
-            }
-          } else {
-            // Header line:  "Name: Value"
-            int colonIdx = req._headerLineBuf.indexOf(':');
-            if (colonIdx > 0) {
-              String name  = req._headerLineBuf.substring(0, colonIdx);
-              String value = req._headerLineBuf.substring(colonIdx + 1);
-              name.trim();
-              value.trim();
-
-              req.response._addHeader(name, value);
-
-              // Track Content-Length
-              if (name.equalsIgnoreCase("Content-Length")) {
-                req.response._contentLength = value.toInt();
-                req.remainingBytes = value.toInt();
-              }
-              // Track Transfer-Encoding: chunked
-              if (name.equalsIgnoreCase("Transfer-Encoding") &&
-                  value.equalsIgnoreCase("chunked")) {
-                req.chunked = true;
-              }
-            }
-          }
-          req._headerLineBuf = "";
-        } else {
-          req._headerLineBuf += c;
-        }
+// Handshake response: only a 101 with the expected Sec-WebSocket-Accept
+// hands the socket over to the frame parser
+void AsyncHTTP::_startWebSocket(AsyncHTTPRequest& req) {
+  int code = req.response._statusCode;
+  if (code != 101) {
+    _finishWithError(req, ASYNC_HTTP_ERR_UPGRADE,
+                     String(F("WebSocket upgrade refused: HTTP ")) +
+                     String(code));
+    return;
+  }
+  if (!req.response.header("Upgrade").equalsIgnoreCase("websocket") ||
+      !req.ws->_accepts(req.response.header("Sec-WebSocket-Accept"))) {
+    _finishWithError(req, ASYNC_HTTP_ERR_UPGRADE,
+                     F("Invalid WebSocket handshake"));
+    return;
+  }
+  _breakerRecord(req, false);
+  req.requestHeaders = "";
+  req.state = STATE_WEBSOCKET;
+  req.ws->_open(req.client);
+}
+
+// Received bytes go to the frame parser; a silent connection is pinged
+// once, then given up after another ASYNC_HTTP_WS_PING_INTERVAL
+void AsyncHTTP::_processWebSocket(AsyncHTTPRequest& req) {
+  AsyncHTTPWebSocket* ws = req.ws;
+  if (!req.quiet) {
+    req.drained = false;
+    while (req.client->available()) {
+      bool done = ws->_receive((uint8_t)req.client->read());
+      if (!req.active) return;          // aborted from a callback
+      if (done) {
+        _finishWebSocket(req, ws->_closeCode, ws->_reason);
+        return;
       }
+    }
+    req.drained = true;
+  }
 
-      // If connection closed before headers finished
-      if (!req.client->connected() && !req.client->available()) {
-        if (req.response._statusCode > 0) {
-          // We got at least a status code – treat as done
-          req.state = STATE_COMPLETE;
-          _finishWithResponse(req);
+  if (ws->_failed || (!req.quiet && !req.client->connected())) {
+    _finishWebSocket(req, 1006, "Connection lost");
+    return;
+  }
+  if (ws->_state == AsyncHTTPWebSocket::WS_CLOSING) {
+    if (millis() - ws->_closeAt > req.timeoutMs) {
+      _finishWebSocket(req, 1006, "Close timed out");
+    }
+    return;
+  }
+  unsigned long idle = millis() - ws->_lastRx;
+  if (ASYNC_HTTP_WS_PING_INTERVAL > 0 && idle > ASYNC_HTTP_WS_PING_INTERVAL) {
+    if (!ws->_pingSent) {
+      ws->ping();
+      ws->_pingSent = true;
+    } else if (idle > 2UL * ASYNC_HTTP_WS_PING_INTERVAL) {
+      _finishWebSocket(req, 1006, "No reply to ping");
+    }
+  }
+}
+
+// The socket is closed (never reused after an upgrade) and the slot freed
+// before onClose, so the callback may reconnect right away
+void AsyncHTTP::_finishWebSocket(AsyncHTTPRequest& req, uint16_t code,
+                                 const char* reason) {
+  AsyncHTTPWebSocket* ws = req.ws;
+  req.state = STATE_COMPLETE;
+  _detachConnection(req, false);
+  req.ws     = nullptr;
+  req.unlinkToken();
+  _releaseSlot(req);
+  ws->_closed(code, reason);
+}
+
+// ===========================================================================
+// Internal: response cache
+// ===========================================================================
+
+// Called from request() once the header block is built: a fresh entry is
+// served from _processSlot(), a stale one gets conditional headers
+void AsyncHTTP::_cacheLookup(AsyncHTTPRequest& req, const String& url) {
+  req.cacheKey = F("GET ");
+  req.cacheKey += url;
+  if (req.method != HTTP_GET) return;   // key kept for invalidation only
+
+  AsyncHTTPCacheEntry entry;
+  if (!_cache->load(req.cacheKey, entry)) return;
+
+  if (entry.maxAgeMs > 0 && millis() - entry.storedAt < entry.maxAgeMs) {
+    req.cacheHit = true;
+    return;
+  }
+  if (entry.etag.length() > 0) {
+    req.requestHeaders += F("If-None-Match: ");
+    req.requestHeaders += entry.etag;
+    req.requestHeaders += F("\r\n");
+  }
+  if (entry.lastModified.length() > 0) {
+    req.requestHeaders += F("If-Modified-Since: ");
+    req.requestHeaders += entry.lastModified;
+    req.requestHeaders += F("\r\n");
+  }
+}
+
+// Cache-Control: max-age in ms (no-cache = 0), -1 if not given
+static long _maxAgeMs(const String& cacheControl) {
+  if (cacheControl.indexOf("no-cache") >= 0) return 0;
+  int i = cacheControl.indexOf("max-age=");
+  if (i < 0) return -1;
+  long s = cacheControl.substring(i + 8).toInt();
+  if (s < 0) return 0;
+  return (s > 0x7FFFFFFFL / 1000) ? 0x7FFFFFFFL : s * 1000;
+}
+
+// Store a 200, refresh the entry on a 304 (and answer with it), drop the
+// entry after a successful unsafe request to the same URL
+void AsyncHTTP::_cacheResponse(AsyncHTTPRequest& req) {
+  int code = req.response._statusCode;
+  if (req.method != HTTP_GET) {
+    if (req.method != HTTP_HEAD && code >= 200 && code < 400) {
+      _cache->remove(req.cacheKey);
+    }
+    return;
+  }
+
+  String cc = req.response.header("Cache-Control");
+  cc.toLowerCase();
+  long   maxAge       = _maxAgeMs(cc);
+  String etag         = req.response.header("ETag");
+  String lastModified = req.response.header("Last-Modified");
+
+  if (code == 304) {
+    AsyncHTTPCacheEntry entry;
+    if (!_cache->load(req.cacheKey, entry)) return;   // pass the 304 on
+    entry.storedAt = millis();
+    if (maxAge >= 0)               entry.maxAgeMs     = maxAge;
+    if (etag.length() > 0)         entry.etag         = etag;
+    if (lastModified.length() > 0) entry.lastModified = lastModified;
+    _cache->save(req.cacheKey, entry);
+    _fillFromCache(req, entry);
+    return;
+  }
+
+  if (code != 200) return;
+  if (cc.indexOf("no-store") >= 0) {
+    _cache->remove(req.cacheKey);
+    return;
+  }
+  // Nothing to reuse without freshness or a validator; a full body buffer
+  // may have been cut short
+  if ((maxAge <= 0 && etag.length() == 0 && lastModified.length() == 0) ||
+      (int)req.response._body.length() >= ASYNC_HTTP_BODY_BUF_SIZE) {
+    return;
+  }
+
+  AsyncHTTPCacheEntry entry;
+  entry.statusCode   = code;
+  entry.etag         = etag;
+  entry.lastModified = lastModified;
+  entry.body         = req.response._body;
+  entry.storedAt     = millis();
+  entry.maxAgeMs     = maxAge > 0 ? maxAge : 0;
+  // The body is stored decoded and de-chunked: its framing headers no
+  // longer apply, so Content-Length is rewritten to the stored length
+  for (uint8_t i = 0; i < req.response._headerCount; i++) {
+    const String& name = req.response._headers[i].name;
+    if (name.equalsIgnoreCase("Content-Encoding") ||
+        name.equalsIgnoreCase("Content-Length") ||
+        name.equalsIgnoreCase("Transfer-Encoding")) {
+      continue;
+    }
+    entry.headers += name;
+    entry.headers += F(": ");
+    entry.headers += req.response._headers[i].value;
+    entry.headers += F("\r\n");
+  }
+  entry.headers += F("Content-Length: ");
+  entry.headers += String((unsigned long)entry.body.length());
+  entry.headers += F("\r\n");
+  _cache->save(req.cacheKey, entry);
+}
+
+void AsyncHTTP::_fillFromCache(AsyncHTTPRequest& req,
+                               const AsyncHTTPCacheEntry& e) {
+  AsyncHTTPResponse& res = req.response;
+  res._statusCode    = e.statusCode;
+  res._body          = e.body;
+  res._contentLength = e.body.length();
+  res._headerCount   = 0;
+
+  int start = 0;
+  int end;
+  while ((end = e.headers.indexOf("\r\n", start)) >= 0) {
+    int colon = e.headers.indexOf(':', start);
+    if (colon > start && colon < end) {
+      String value = e.headers.substring(colon + 1, end);
+      value.trim();
+      res._addHeader(e.headers.substring(start, colon), value);
+    }
+    start = end + 2;
+  }
+}
+
+// ===========================================================================
+// Readiness – lwIP select() instead of polling every socket (ESP32)
+// ===========================================================================
+
+#if ASYNC_HTTP_SELECT
+
+// Descriptor of a plain socket made by _createClient(), else -1. TLS keeps
+// decrypted bytes in its own buffer and a user-supplied Client need not be
+// a WiFiClient, so those are always read by polling.
+int AsyncHTTP::_socketOf(const AsyncHTTPRequest& req) const {
+  if (req.conn < 0) return -1;
+  const AsyncHTTPConnection& c = _conns[req.conn];
+  if (!c.owned || c.tls || !c.client) return -1;
+  int fd = static_cast<WiFiClient*>(c.client)->fd();
+  return fd < FD_SETSIZE ? fd : -1;
+}
+
+// Add the sockets of slots waiting for data that were read dry last time
+// (their quiet flag is set until select() says otherwise). With `waitMs`,
+// it is also lowered to the nearest timer, or to 0 if a slot has other
+// work. Returns the highest descriptor, -1 if none.
+int AsyncHTTP::_watchSockets(fd_set& fds, unsigned long* waitMs) {
+  FD_ZERO(&fds);
+  int maxFd = -1;
+  unsigned long now = millis();
+  for (int8_t i = _nextActive(0); i >= 0; i = _nextActive(i + 1)) {
+    AsyncHTTPRequest& req = _requests[i];
+    req.quiet = false;
+
+    bool receiving = req.state == STATE_RECEIVING_HEADERS ||
+                     req.state == STATE_RECEIVING_BODY ||
+                     req.state == STATE_WEBSOCKET;
+    unsigned long due = 0;              // ms until the slot needs update()
+    if (req.state == STATE_BACKOFF) {
+      long left = (long)(req.retryAt - now);
+      due = left > 0 ? (unsigned long)left : 0;
+    } else if (receiving && !req.cacheHit) {
+      bool head = _conns[req.conn].head == i;
+      int  fd   = head && req.drained ? _socketOf(req) : -1;
+      if (fd >= 0 || !head) {
+        if (fd >= 0) {
+          FD_SET(fd, &fds);
+          if (fd > maxFd) maxFd = fd;
+          req.quiet = true;
+        }
+        if (req.state != STATE_WEBSOCKET) {
+          unsigned long used = now - req.startTime;
+          due = used < req.timeoutMs ? req.timeoutMs - used : 0;
+        } else if (req.ws->_failed) {
+          due = 0;
+        } else if (req.ws->_state == AsyncHTTPWebSocket::WS_CLOSING) {
+          unsigned long used = now - req.ws->_closeAt;
+          due = used < req.timeoutMs ? req.timeoutMs - used : 0;
+        } else if (ASYNC_HTTP_WS_PING_INTERVAL > 0) {
+          unsigned long limit = (req.ws->_pingSent ? 2UL : 1UL) *
+                                ASYNC_HTTP_WS_PING_INTERVAL + 1;
+          unsigned long used  = now - req.ws->_lastRx;
+          due = used < limit ? limit - used : 0;
         } else {
-          _finishWithError(req, ASYNC_HTTP_ERR_PARSE_FAIL,
-                           F("Connection closed during headers"));
+          due = (unsigned long)-1;
         }
       }
-      break;
     }
+    if (waitMs && due < *waitMs) *waitMs = due;
+  }
+  return maxFd;
+}
 
-    // ---------------------------------------------------------------
-    case STATE_RECEIVING_BODY: {
-      // Read available bytes
-      while (req.client->available()) {
-        char c = (char)req.client->read();
+// Once per update(): slots whose socket has nothing new skip reading
+// (select() also reports a closed or failed socket as readable)
+void AsyncHTTP::_pollSockets() {
+  fd_set fds;
+  int maxFd = _watchSockets(fds, nullptr);
+  if (maxFd < 0) return;
+  struct timeval tv = {0, 0};
+  bool failed = select(maxFd + 1, &fds, nullptr, nullptr, &tv) < 0;
+  for (int8_t i = _nextActive(0); i >= 0; i = _nextActive(i + 1)) {
+    AsyncHTTPRequest& req = _requests[i];
+    if (req.quiet && (failed || FD_ISSET(_socketOf(req), &fds))) {
+      req.quiet = false;
+    }
+  }
+}
 
-        if (req.chunked) {
-          // Simple chunked parser: read chunk size line, then data
-          // This is a lightweight implementation; for very large
-          // chunked responses consider streaming
-          req.response._body += c;
-        } else {
-          req.response._body += c;
-          if (req.remainingBytes > 0) {
-            req.remainingBytes--;
-            if (req.remainingBytes == 0) {
-              req.state = STATE_COMPLETE;
-              _finishWithResponse(req);
-              return;
-            }
-          }
-        }
+#endif // ASYNC_HTTP_SELECT
+
+bool AsyncHTTP::waitForActivity(unsigned long timeoutMs) {
+#if ASYNC_HTTP_SELECT
+  fd_set fds;
+  unsigned long waitMs = timeoutMs;
+  int maxFd = _watchSockets(fds, &waitMs);
+  if (waitMs == 0) return true;
+  if (maxFd < 0) {
+    delay(waitMs);                      // only timers to wait for
+    return waitMs < timeoutMs;
+  }
+  struct timeval tv;
+  tv.tv_sec  = waitMs / 1000;
+  tv.tv_usec = (waitMs % 1000) * 1000;
+  int n = select(maxFd + 1, &fds, nullptr, nullptr, &tv);
+  return n != 0 || waitMs < timeoutMs;
+#else
+  (void)timeoutMs;
+  return true;
+#endif
+}
 
-        // Safety: limit body size
-        if ((int)req.response._body.length() >= ASYNC_HTTP_BODY_BUF_SIZE) {
-          req.state = STATE_COMPLETE;
-          _finishWithResponse(req);
-          return;
-        }
+// ===========================================================================
+// Internal: connection pool
+// ===========================================================================
+
+static bool _isIdempotent(AsyncHTTPMethod m) {
+  return m == HTTP_GET || m == HTTP_HEAD || m == HTTP_PUT || m == HTTP_DELETE;
+}
+
+// A request may be sent again on a fresh socket if a kept-alive socket
+// failed before any byte of its response arrived
+bool AsyncHTTP::_canResend(const AsyncHTTPRequest& req) const {
+  return (_keepAlive || req.longPoll) && req.conn >= 0 && !req.reissued &&
+         !req.gotBytes && _isIdempotent(req.method);
+}
+
+bool AsyncHTTP::_attachConnection(AsyncHTTPRequest& req) {
+  int8_t self = _slotOf(req);
+  const char* host = req.connectHost();
+  bool pipelinable = _pipelineDepth > 1 && !req.noPipeline && !req.events &&
+                     !req.ws && !req.longPoll &&
+                     (req.method == HTTP_GET || req.method == HTTP_HEAD);
+
+  // ---- Reuse a socket to the same host ----
+  if (_keepAlive) {
+    for (int8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
+      AsyncHTTPConnection& conn = _conns[i];
+      if (!conn.open || conn.port != req.port || conn.tls != req.tls ||
+          strcasecmp(conn.host.c_str(), host) != 0) {
+        continue;
       }
 
-      // Connection closed → done
-      if (!req.client->connected() && !req.client->available()) {
-        // For chunked encoding, strip chunk metadata
-        if (req.chunked) {
-          _stripChunkedEncoding(req.response._body);
+      if (conn.users == 0) {
+        if (!conn.client->connected()) {   // closed by the server while idle
+          _closeConnection(i, false, -1);
+          continue;
         }
-        req.state = STATE_COMPLETE;
-        _finishWithResponse(req);
+        conn.users       = 1;
+        conn.head        = conn.tail = self;
+        conn.pipelinable = pipelinable;
+        req.conn         = i;
+        req.client       = conn.client;
+        return true;
+      }
+
+      if (pipelinable && conn.pipelinable && conn.users < _pipelineDepth) {
+        _requests[conn.tail].pipeNext = self;
+        conn.tail   = self;
+        conn.users++;
+        req.conn    = i;
+        req.client  = conn.client;
+        return true;
       }
-      break;
     }
+  }
 
-    // ---------------------------------------------------------------
-    case STATE_COMPLETE:
-    case STATE_ERROR:
-    case STATE_TIMEOUT:
-    case STATE_IDLE:
-    default:
+  // ---- Take a free socket: prefer a closed one, else the longest idle ----
+  int8_t best = -1;
+  for (int8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
+    AsyncHTTPConnection& conn = _conns[i];
+    if (conn.users > 0) continue;
+    if (!_ownsClients && !conn.client) continue;
+    if (!conn.open) { best = i; break; }
+    if (best < 0 || (long)(conn.idleSince - _conns[best].idleSince) < 0) {
+      best = i;
+    }
+  }
+  if (best < 0) return false;
+
+  AsyncHTTPConnection& conn = _conns[best];
+  if (conn.open) _closeConnection(best, false, -1);
+
+  if (_ownsClients) {
+    if (conn.client && conn.tls != req.tls) {
+      _destroyClient(conn.client, conn.tls);
+      conn.client = nullptr;
+    }
+    if (!conn.client) {
+      conn.client = _createClient(req.tls);
+      conn.owned  = true;
+      if (!conn.client) return false;
+    }
+  }
+
+  conn.host        = host;
+  conn.port        = req.port;
+  conn.tls         = req.tls;
+  conn.users       = 1;
+  conn.head        = conn.tail = self;
+  conn.pipelinable = pipelinable;
+  req.conn         = best;
+  req.client       = conn.client;
+  return true;
+}
+
+// Called when the head request of a socket is done with it
+void AsyncHTTP::_detachConnection(AsyncHTTPRequest& req, bool reusable) {
+  int8_t c = req.conn;
+  if (c < 0) return;
+
+  if (!reusable) {
+    _closeConnection(c, false, _slotOf(req));
+    return;
+  }
+
+  // Pop the FIFO head; the next pipelined request now owns the read side
+  AsyncHTTPConnection& conn = _conns[c];
+  conn.head = req.pipeNext;
+  conn.users--;
+  if (conn.head < 0) {
+    conn.tail      = -1;
+    conn.users     = 0;
+    conn.idleSince = millis();
+  }
+  req.conn     = -1;
+  req.client   = nullptr;
+  req.pipeNext = -1;
+}
+
+// Close a socket. Requests still queued on it (other than `except`) are
+// sent again on a fresh connection; if `failed`, each may be re-sent once.
+void AsyncHTTP::_closeConnection(int8_t c, bool failed, int8_t except) {
+  AsyncHTTPConnection& conn = _conns[c];
+  int8_t s = conn.head;
+
+  conn.open        = false;
+  conn.pipelinable = false;
+  conn.users       = 0;
+  conn.head        = conn.tail = -1;
+  if (conn.client) {
+    conn.client->stop();
+    if (conn.owned) {
+      _destroyClient(conn.client, conn.tls);  // free heap between requests
+      conn.client = nullptr;
+    }
+  }
+
+  while (s >= 0) {
+    AsyncHTTPRequest& r = _requests[s];
+    int8_t next = r.pipeNext;
+    r.conn     = -1;
+    r.client   = nullptr;
+    r.pipeNext = -1;
+    if (s != except) {
+      if (failed && r.reissued) {
+        _finishWithError(r, ASYNC_HTTP_ERR_CONNECT_FAIL,
+                         F("Connection lost"));
+      } else {
+        r.reissued   = r.reissued || failed;
+        r.noPipeline = true;
+        r.resetResponse();
+        r.state = STATE_CONNECTING;
+      }
+    }
+    s = next;
+  }
+}
+
+// ===========================================================================
+// Internal: redirects – the slot is reused; the socket too when the target
+// is on the same keep-alive connection
+// ===========================================================================
+
+bool AsyncHTTP::_redirect(AsyncHTTPRequest& req, bool reusable) {
+  int code = req.response._statusCode;
+  if (req.redirects >= _maxRedirects || code == 304 || code == 305 ||
+      code == 306) {
+    return false;
+  }
+  String location = req.response.header("Location");
+  location.trim();
+  if (location.length() == 0) return false;
+
+  // Resolve the target against the current URL
+  const String& curPath = req.tmpl ? req.tmpl->_path : req.path;
+  String   host = req.connectHost();
+  uint16_t port = req.port;
+  bool     tls  = req.tls;
+  String   path;
+  // Only an http(s):// or scheme-relative // prefix makes it absolute; a
+  // "://" further on (as in "?next=http://x") belongs to a relative target
+  if (location.startsWith("//")) {
+    location = (tls ? F("https:") : F("http:")) + location;
+  }
+  int q = curPath.indexOf('?');
+  String dir = (q >= 0) ? curPath.substring(0, q) : curPath;
+  if (strncasecmp(location.c_str(), "http://", 7) == 0 ||
+      strncasecmp(location.c_str(), "https://", 8) == 0) {
+    if (!_parseUrl(location, host, port, path, tls)) return false;
+  } else if (location[0] == '/') {
+    path = location;
+  } else if (location[0] == '?') {
+    path = dir + location;              // same path, new query
+  } else {
+    path = dir.substring(0, dir.lastIndexOf('/') + 1) + location;
+  }
+  int frag = path.indexOf('#');
+  if (frag >= 0) path.remove(frag);
+  if (path.length() == 0) path = "/";
+
+  if (req.tls && !tls && !_redirectInsecure) return false;
+
+  // 303 (and 301/302 after POST, as browsers do) continue as a GET
+  String contentType = req.tmpl ? req.tmpl->_contentType : req.contentType;
+  if ((code == 303 && req.method != HTTP_HEAD) ||
+      ((code == 301 || code == 302) && req.method == HTTP_POST)) {
+    req.method      = HTTP_GET;
+    req.requestBody = "";
+    req.multipart   = nullptr;
+    contentType     = "";
+#if ASYNC_HTTP_JSON
+    req.jsonBody    = nullptr;
+#endif
+  }
+
+  // Release (or keep) the socket, then restart the slot on the new target
+  _detachConnection(req, reusable);
+  req.tmpl        = nullptr;
+  req.host        = host;
+  req.port        = port;
+  req.tls         = tls;
+  req.path        = path;
+  req.contentType = contentType;
+  _buildRequestHeader(req.requestHeaders, req.method, req.host, req.port,
+                      req.tls, req.path, contentType,
+                      req.onDataCb != nullptr || req.events != nullptr);
+
+  req.redirects++;
+  req.cacheKey     = "";                // only the first URL is cached
+  req.reissued     = false;
+  req.rateAdmitted = false;
+  req.resetResponse();
+  req.state     = STATE_CONNECTING;
+  req.startTime = millis();
+  return true;
+}
+
+// ===========================================================================
+// Rate limiting – token bucket per host / URL prefix
+// ===========================================================================
+
+bool AsyncHTTP::setRateLimit(const String& match, unsigned long intervalMs,
+                             uint8_t burst) {
+  // "host" or "scheme://host[:port]/path-prefix"
+  String host;
+  String prefix;
+  if (match.indexOf("://") >= 0) {
+    AsyncHTTPUrl u;
+    if (!u.parse(match.c_str())) return false;
+    host.concat(match.c_str() + u.host.off, u.host.len);
+    prefix.concat(match.c_str() + u.target.off, u.target.len);
+  } else {
+    host = match;
+  }
+  if (host.length() == 0) return false;
+
+  AsyncHTTPRateLimit* slot = nullptr;
+  for (uint8_t i = 0; i < ASYNC_HTTP_RATE_LIMITS; i++) {
+    AsyncHTTPRateLimit& r = _rateLimits[i];
+    if (r.host.equalsIgnoreCase(host) && r.pathPrefix == prefix) {
+      slot = &r;
       break;
+    }
+    if (!slot && r.host.length() == 0) slot = &r;
+  }
+  if (intervalMs == 0) {
+    if (slot && slot->host.length() > 0) *slot = AsyncHTTPRateLimit();
+    return true;
+  }
+  if (!slot) return false;
+
+  slot->host       = host;
+  slot->pathPrefix = prefix;
+  slot->intervalMs = intervalMs;
+  slot->burst      = burst > 0 ? burst : 1;
+  slot->tokens     = slot->burst;
+  slot->lastRefill = millis();
+  return true;
+}
+
+// The first bucket matching host and path, refilled up to now; nullptr if
+// no rule applies
+AsyncHTTPRateLimit* AsyncHTTP::_rateBucket(const char* host,
+                                           const String& path) {
+  for (uint8_t i = 0; i < ASYNC_HTTP_RATE_LIMITS; i++) {
+    AsyncHTTPRateLimit& r = _rateLimits[i];
+    if (r.host.length() == 0 || strcasecmp(r.host.c_str(), host) != 0 ||
+        !path.startsWith(r.pathPrefix)) {
+      continue;
+    }
+
+    unsigned long now = millis();
+    unsigned long n   = (now - r.lastRefill) / r.intervalMs;
+    if (n > 0) {
+      r.tokens     = (n >= (unsigned long)(r.burst - r.tokens))
+                     ? r.burst : (uint8_t)(r.tokens + n);
+      r.lastRefill = (r.tokens == r.burst) ? now
+                                           : r.lastRefill + n * r.intervalMs;
+    }
+    return &r;
+  }
+  return nullptr;
+}
+
+// True if a request to `url` would be refused for want of a token (used to
+// keep batch items queued without taking a slot)
+bool AsyncHTTP::_rateLimited(const String& url) {
+  String   host, path;
+  uint16_t port;
+  bool     tls;
+  if (!_parseUrl(url, host, port, path, tls)) return false;
+  AsyncHTTPRateLimit* r = _rateBucket(host.c_str(), path);
+  return r && r->tokens == 0;
+}
+
+// Take a token from the first matching bucket; false = throttled
+bool AsyncHTTP::_rateAllow(AsyncHTTPRequest& req) {
+  if (req.rateAdmitted) return true;
+
+  AsyncHTTPRateLimit* r = _rateBucket(req.connectHost(),
+                                      req.tmpl ? req.tmpl->_path : req.path);
+  if (r) {
+    if (r->tokens == 0) return false;
+    r->tokens--;
   }
+  req.rateAdmitted = true;
+  return true;
 }
 
 // ===========================================================================
-// Internal: finish helpers
+// Internal: circuit breaker
 // ===========================================================================
 
-void AsyncHTTP::_finishWithError(AsyncHTTPRequest& req, int code,
-                                  const String& msg) {
-  req.state = STATE_ERROR;
-  if (req.client) req.client->stop();
+AsyncHTTPBreakerState AsyncHTTP::breakerState(const String& host) const {
+  AsyncHTTPBreaker* b = _findBreaker(host.c_str());
+  if (!b) return BREAKER_CLOSED;
+  if (b->state == BREAKER_OPEN && millis() - b->openedAt >= _breakerCooldown) {
+    return BREAKER_HALF_OPEN;           // becomes so on the next request
+  }
+  return b->state;
+}
 
-  // Fire per-request or global error callback
-  if (req.onErrorCb) {
-    req.onErrorCb(code, msg, req.onErrorData);
+uint8_t AsyncHTTP::breakerFailures(const String& host) const {
+  AsyncHTTPBreaker* b = _findBreaker(host.c_str());
+  return b ? b->failures : 0;
+}
+
+AsyncHTTPBreaker* AsyncHTTP::_findBreaker(const char* host) const {
+  for (uint8_t i = 0; i < ASYNC_HTTP_BREAKER_HOSTS; i++) {
+    if (_breakers[i].host.length() > 0 &&
+        strcasecmp(_breakers[i].host.c_str(), host) == 0) {
+      return const_cast<AsyncHTTPBreaker*>(&_breakers[i]);
+    }
   }
+  return nullptr;
+}
 
-  // Cleanup
-  if (_ownsClients) {
-    // Find the slot index for this request
-    for (uint8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
-      if (&_requests[i] == &req && _ownedClients[i]) {
-        _destroyClient(_ownedClients[i], req.tls);
-        _ownedClients[i] = nullptr;
+// Admission check before a request takes a socket
+bool AsyncHTTP::_breakerAllow(AsyncHTTPRequest& req) {
+  if (_breakerThreshold == 0) return true;
+  AsyncHTTPBreaker* b = _findBreaker(req.connectHost());
+  if (!b || b->state == BREAKER_CLOSED) return true;
+
+  if (b->state == BREAKER_OPEN) {
+    if (millis() - b->openedAt < _breakerCooldown) return false;
+    b->state = BREAKER_HALF_OPEN;
+    b->probe = -1;
+  }
+
+  // Half-open: one probe at a time (a new one if the last was aborted)
+  int8_t self = _slotOf(req);
+  if (b->probe == self && req.breakerProbe) return true;
+  if (b->probe >= 0 && _requests[b->probe].active &&
+      _requests[b->probe].breakerProbe) {
+    return false;
+  }
+  b->probe         = self;
+  req.breakerProbe = true;
+  return true;
+}
+
+void AsyncHTTP::_breakerRecord(AsyncHTTPRequest& req, bool failed) {
+  req.breakerProbe = false;
+  if (_breakerThreshold == 0) return;
+
+  const char*       host = req.connectHost();
+  AsyncHTTPBreaker* b    = _findBreaker(host);
+  if (!failed) {
+    if (b) *b = AsyncHTTPBreaker();     // healthy again – free the entry
+    return;
+  }
+
+  if (!b) {
+    // Take a free entry, else the closed one with the fewest failures
+    for (uint8_t i = 0; i < ASYNC_HTTP_BREAKER_HOSTS; i++) {
+      AsyncHTTPBreaker& e = _breakers[i];
+      if (e.host.length() == 0) {
+        b = &e;
         break;
       }
+      if (e.state == BREAKER_CLOSED && (!b || e.failures < b->failures)) b = &e;
     }
+    if (!b) return;                     // every tracked host is open
+    *b = AsyncHTTPBreaker();
+    b->host = host;
+  }
+
+  if (b->failures < 255) b->failures++;
+  if (b->state == BREAKER_HALF_OPEN || b->failures >= _breakerThreshold) {
+    b->state    = BREAKER_OPEN;
+    b->openedAt = millis();
+    b->probe    = -1;
   }
-  req.client = nullptr;
-  req.active = false;
 }
 
-void AsyncHTTP::_finishWithResponse(AsyncHTTPRequest& req) {
-  req.state = STATE_COMPLETE;
-  if (req.client) req.client->stop();
+// ===========================================================================
+// Internal: retry policy
+// ===========================================================================
 
-  // Fire callback
-  if (req.onResponseCb) {
-    req.onResponseCb(req.response, req.onResponseData);
+// Park the request in STATE_BACKOFF. `safe` – the server cannot have acted
+// on it; `delayMs` < 0 picks exponential back-off with jitter. Returns false
+// if the request is out of attempts or must not be repeated.
+bool AsyncHTTP::_retry(AsyncHTTPRequest& req, bool safe, long delayMs,
+                       bool reusable) {
+  uint8_t limit = _retryMax;
+  if (req.onDataCb && limit < ASYNC_HTTP_DOWNLOAD_ATTEMPTS) {
+    limit = ASYNC_HTTP_DOWNLOAD_ATTEMPTS;
+  }
+  if (req.attempts + 1 >= limit) return false;
+  if (!safe && !_isIdempotent(req.method)) return false;
+
+  if (delayMs < 0) {
+    // base · 2^n, capped; the lower half is fixed, the upper half random
+    unsigned long d = _retryBase;
+    for (uint8_t i = 0; i < req.attempts && d < _retryMaxDelay; i++) d <<= 1;
+    if (d > _retryMaxDelay) d = _retryMaxDelay;
+    delayMs = d / 2 + random((long)(d / 2) + 1);
+  } else if ((unsigned long)delayMs > _retryMaxDelay) {
+    return false;                       // Retry-After too far away
   }
 
-  // Cleanup
-  if (_ownsClients) {
-    for (uint8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
-      if (&_requests[i] == &req && _ownedClients[i]) {
-        _destroyClient(_ownedClients[i], req.tls);
-        _ownedClients[i] = nullptr;
-        break;
-      }
+  req.attempts++;
+  req.rateAdmitted = false;             // every attempt needs a token
+  _detachConnection(req, reusable);
+  req.resetResponse();
+  req.state   = STATE_BACKOFF;
+  req.retryAt = millis() + delayMs;
+  return true;
+}
+
+void AsyncHTTP::_expireIdleConnections() {
+  for (int8_t i = 0; i < ASYNC_HTTP_MAX_REQUESTS; i++) {
+    AsyncHTTPConnection& conn = _conns[i];
+    if (conn.open && conn.users == 0 &&
+        millis() - conn.idleSince > ASYNC_HTTP_KEEPALIVE_IDLE) {
+      _closeConnection(i, false, -1);
     }
   }
-  req.client = nullptr;
-  req.active = false;
 }
 
 // ===========================================================================
@@ -32,12 +32,33 @@
   #define ASYNC_HTTP_SSL_SUPPORT 0
 #endif
 
+// ---------------------------------------------------------------------------
+// ArduinoJson integration (getJson / requestJson) when the library is present
+// ---------------------------------------------------------------------------
+#ifndef ASYNC_HTTP_JSON
+  #if defined(__has_include)
+    #if __has_include(<ArduinoJson.h>)
+      #define ASYNC_HTTP_JSON 1
+    #endif
+  #endif
+#endif
+#ifndef ASYNC_HTTP_JSON
+  #define ASYNC_HTTP_JSON 0
+#endif
+#if ASYNC_HTTP_JSON
+  #include <ArduinoJson.h>
+#endif
+
 // ---------------------------------------------------------------------------
 // Configuration defaults
 // ---------------------------------------------------------------------------
 #ifndef ASYNC_HTTP_MAX_REQUESTS
   #define ASYNC_HTTP_MAX_REQUESTS    4        // max concurrent requests
 #endif
+#if ASYNC_HTTP_MAX_REQUESTS > 127
+  #error "ASYNC_HTTP_MAX_REQUESTS must not exceed 127"
+#endif
+#define ASYNC_HTTP_SLOT_WORDS ((ASYNC_HTTP_MAX_REQUESTS + 31) / 32)
 
 #ifndef ASYNC_HTTP_HEADER_BUF_SIZE
   #define ASYNC_HTTP_HEADER_BUF_SIZE 512      // header line buffer
@@ -55,6 +76,97 @@
   #define ASYNC_HTTP_MAX_HEADERS     16       // max stored response headers
 #endif
 
+#ifndef ASYNC_HTTP_KEEPALIVE_IDLE
+  #define ASYNC_HTTP_KEEPALIVE_IDLE  30000    // close idle keep-alive sockets after 30 s
+#endif
+
+#ifndef ASYNC_HTTP_PIPELINE_DEPTH
+  #define ASYNC_HTTP_PIPELINE_DEPTH  4        // max requests queued on one socket
+#endif
+
+#ifndef ASYNC_HTTP_RETRY_BASE_DELAY
+  #define ASYNC_HTTP_RETRY_BASE_DELAY 500     // first retry back-off (ms)
+#endif
+
+#ifndef ASYNC_HTTP_RETRY_MAX_DELAY
+  #define ASYNC_HTTP_RETRY_MAX_DELAY 30000    // back-off / Retry-After cap (ms)
+#endif
+
+#ifndef ASYNC_HTTP_BREAKER_HOSTS
+  #define ASYNC_HTTP_BREAKER_HOSTS   4        // hosts tracked by the circuit breaker
+#endif
+
+#ifndef ASYNC_HTTP_BREAKER_COOLDOWN
+  #define ASYNC_HTTP_BREAKER_COOLDOWN 30000   // open breaker rejects for 30 s
+#endif
+
+#ifndef ASYNC_HTTP_RATE_LIMITS
+  #define ASYNC_HTTP_RATE_LIMITS     4        // token buckets (see setRateLimit)
+#endif
+
+#ifndef ASYNC_HTTP_COALESCE_WAITERS
+  #define ASYNC_HTTP_COALESCE_WAITERS 3       // extra callbacks per coalesced GET
+#endif
+
+#ifndef ASYNC_HTTP_DOWNLOAD_CHUNK
+  #define ASYNC_HTTP_DOWNLOAD_CHUNK  512      // bytes per download onData() call
+#endif
+
+#ifndef ASYNC_HTTP_DOWNLOAD_ATTEMPTS
+  #define ASYNC_HTTP_DOWNLOAD_ATTEMPTS 5      // resumes without progress before giving up
+#endif
+
+#ifndef ASYNC_HTTP_SSE_RETRY
+  #define ASYNC_HTTP_SSE_RETRY       3000     // event stream reconnect delay (ms)
+#endif
+
+#ifndef ASYNC_HTTP_SSE_IDLE_TIMEOUT
+  #define ASYNC_HTTP_SSE_IDLE_TIMEOUT 60000   // reconnect a silent event stream after (ms)
+#endif
+
+#ifndef ASYNC_HTTP_LONGPOLL_RETRY
+  #define ASYNC_HTTP_LONGPOLL_RETRY  1000     // long poll delay after a failure / non-2xx (ms)
+#endif
+
+#ifndef ASYNC_HTTP_WS_PING_INTERVAL
+  #define ASYNC_HTTP_WS_PING_INTERVAL 30000   // ping a silent WebSocket after (ms, 0 = off)
+#endif
+
+#ifndef ASYNC_HTTP_INFLATE_WINDOW
+  #define ASYNC_HTTP_INFLATE_WINDOW  32768    // gzip/deflate history window
+#endif
+
+#ifndef ASYNC_HTTP_DEFLATE_WINDOW
+  #define ASYNC_HTTP_DEFLATE_WINDOW  2048     // request compression window (6x RAM)
+#endif
+
+#ifndef ASYNC_HTTP_COMPRESS_MIN_SIZE
+  #define ASYNC_HTTP_COMPRESS_MIN_SIZE 256    // smaller bodies are sent as is
+#endif
+
+#ifndef ASYNC_HTTP_UPLOAD_CHUNK
+  #define ASYNC_HTTP_UPLOAD_CHUNK    512      // multipart body bytes sent per update()
+#endif
+
+#ifndef ASYNC_HTTP_JSON_BODY_SIZE
+  #define ASYNC_HTTP_JSON_BODY_SIZE  ASYNC_HTTP_BODY_BUF_SIZE // largest JSON body
+#endif
+
+#ifndef ASYNC_HTTP_JSON_WRITE_BUF
+  #define ASYNC_HTTP_JSON_WRITE_BUF  64       // socket write size for JsonDocument bodies
+#endif
+
+#ifndef ASYNC_HTTP_SELECT
+  #if defined(ESP32)
+    #define ASYNC_HTTP_SELECT        1        // lwIP select() skips idle sockets
+  #else
+    #define ASYNC_HTTP_SELECT        0
+  #endif
+#endif
+#if ASYNC_HTTP_SELECT
+  #include <lwip/sockets.h>
+#endif
+
 // ---------------------------------------------------------------------------
 // HTTP Method enum
 // ---------------------------------------------------------------------------
@@ -78,13 +190,33 @@ enum AsyncHTTPState {
   STATE_RECEIVING_BODY,
   STATE_COMPLETE,
   STATE_ERROR,
-  STATE_TIMEOUT
+  STATE_TIMEOUT,
+  STATE_BACKOFF,         // waiting to retry (see AsyncHTTP::setRetry)
+  STATE_UPLOADING,       // sending a multipart body piece by piece
+  STATE_WEBSOCKET        // upgraded – socket driven by AsyncHTTPWebSocket
+};
+
+// ---------------------------------------------------------------------------
+// Circuit breaker state of a host (see AsyncHTTP::setCircuitBreaker)
+// ---------------------------------------------------------------------------
+enum AsyncHTTPBreakerState {
+  BREAKER_CLOSED = 0,    // requests pass
+  BREAKER_OPEN,          // requests fail with ASYNC_HTTP_ERR_CIRCUIT_OPEN
+  BREAKER_HALF_OPEN      // cooldown over – one probe request may pass
 };
 
 // ---------------------------------------------------------------------------
 // Forward declaration
 // ---------------------------------------------------------------------------
 class AsyncHTTP;
+class AsyncHTTPInflate;
+class AsyncHTTPCacheStore;
+struct AsyncHTTPCacheEntry;
+class AsyncHTTPMultipart;
+class AsyncHTTPEventParser;
+class AsyncHTTPWebSocket;
+class AsyncHTTPBatch;
+struct AsyncHTTPRequest;
 
 // ---------------------------------------------------------------------------
 // AsyncHTTPResponse  – result container passed to the user callback
@@ -115,11 +247,87 @@ private:
   void _addHeader(const String& name, const String& value);
 };
 
+// ---------------------------------------------------------------------------
+// AsyncHTTPUrl – zero-allocation URL parser
+//   http(s)://[userinfo@]host[:port][/path][?query][#fragment]
+// Components are returned as offset/length spans into the source string.
+// ---------------------------------------------------------------------------
+struct AsyncHTTPSpan {
+  uint16_t off = 0;
+  uint16_t len = 0;
+};
+
+struct AsyncHTTPUrl {
+  bool          tls   = false;
+  bool          ipv6  = false;    // host was a bracketed IPv6 literal
+  uint16_t      port  = 80;
+  AsyncHTTPSpan userinfo;         // without the trailing '@'
+  AsyncHTTPSpan host;             // without the '[' ']' brackets
+  AsyncHTTPSpan target;           // path + query, empty means "/"
+  AsyncHTTPSpan query;            // without the leading '?'
+
+  /// Parse `url` without allocating. Rejects unknown schemes, empty hosts,
+  /// malformed ports and invalid percent-encoding.
+  bool parse(const char* url);
+};
+
+// ---------------------------------------------------------------------------
+// AsyncHTTPTemplate – pre-parsed URL + pre-built header block for an endpoint
+// that is requested repeatedly (see AsyncHTTP::prepare / AsyncHTTP::send)
+// ---------------------------------------------------------------------------
+class AsyncHTTPTemplate {
+public:
+  bool isValid() const { return _valid; }
+
+private:
+  friend class AsyncHTTP;
+  friend struct AsyncHTTPRequest;
+  bool            _valid   = false;
+  AsyncHTTPMethod _method  = HTTP_GET;
+  String          _host;
+  uint16_t        _port    = 80;
+  bool            _tls     = false;
+  String          _path;          // kept for resolving relative redirects
+  String          _contentType;
+  String          _header;        // request line, Host, defaults, Content-Type
+};
+
+// ---------------------------------------------------------------------------
+// AsyncHTTPCancelToken – cancels a group of requests at once
+// (see AsyncHTTP::setCancelToken). Requests are linked through their slots,
+// so cancelling touches only the requests tied to the token, and a request
+// that ends unlinks itself. Destroying the token cancels its requests.
+// ---------------------------------------------------------------------------
+class AsyncHTTPCancelToken {
+public:
+  AsyncHTTPCancelToken() {}
+  ~AsyncHTTPCancelToken() { cancel(); }
+
+  /// Abort every running request tied to the token (no callbacks)
+  void    cancel();
+
+  /// Number of running requests tied to the token
+  uint8_t pending() const { return _count; }
+
+private:
+  friend class AsyncHTTP;
+  friend struct AsyncHTTPRequest;
+  AsyncHTTPCancelToken(const AsyncHTTPCancelToken&) = delete;
+  AsyncHTTPCancelToken& operator=(const AsyncHTTPCancelToken&) = delete;
+
+  AsyncHTTP*        _http  = nullptr;
+  AsyncHTTPRequest* _head  = nullptr;
+  uint8_t           _count = 0;
+};
+
 // ---------------------------------------------------------------------------
 // AsyncHTTPRequest – internal bookkeeping for one in-flight request
 // ---------------------------------------------------------------------------
 struct AsyncHTTPRequest {
   bool            active          = false;
+  int             id              = -1;   // handle: sequence << 8 | slot
+  int8_t          slot            = -1;   // own index in the pool
+  int8_t          nextFree        = -1;   // free list link while idle
   AsyncHTTPState  state           = STATE_IDLE;
 
   // Request data
@@ -130,6 +338,11 @@ struct AsyncHTTPRequest {
   bool            tls             = false;
   String          requestHeaders;       // pre-built header lines
   String          requestBody;
+  String          contentType;          // kept for 307/308 redirects
+  const AsyncHTTPTemplate* tmpl   = nullptr;  // set when sent via a template
+  uint8_t         redirects       = 0;    // hops followed so far
+
+  const char* connectHost() const { return tmpl ? tmpl->_host.c_str() : host.c_str(); }
 
   // Timeout
   unsigned long   timeoutMs       = ASYNC_HTTP_DEFAULT_TIMEOUT;
@@ -141,20 +354,151 @@ struct AsyncHTTPRequest {
   bool            chunked         = false;
   int             remainingBytes  = -1;   // for Content-Length
   String          _headerLineBuf;
+  uint8_t         chunkState      = 0;    // incremental chunked decoder
+  long            chunkRemaining  = 0;
+  bool            connClose       = false; // server will close after this response
+  bool            gotBytes        = false; // any response byte received
+  AsyncHTTPInflate* inflate       = nullptr; // Content-Encoding decoder
+  bool            inflateBusy     = false; // inflate is inside write() / flush()
+
+  // Download (streamed to onDataCb, resumed with Range / If-Range)
+  uint32_t        rangeNext       = 0;    // offset of the next body byte
+  long            rangeEnd        = -1;   // last byte wanted, -1 = open / unknown
+  String          ifRange;              // validator of the first response
+  bool            streamBody      = false; // 2xx body goes to onDataCb
+  int8_t          group           = -1;   // first slot of a parallel download
+
+#if ASYNC_HTTP_JSON
+  // JSON response (2xx body collected, then parsed into a JsonDocument)
+  enum { JSON_OFF = 0, JSON_WANTED, JSON_COLLECTING };
+  uint8_t              jsonState  = JSON_OFF;
+  JsonDocument*        json       = nullptr;
+  const JsonDocument*  jsonFilter = nullptr; // not owned
+  const JsonDocument*  jsonBody   = nullptr; // serialized at send, not owned
+  bool collectsJson() const { return jsonState == JSON_COLLECTING; }
+#else
+  bool collectsJson() const { return false; }
+#endif
+
+  // Multipart upload (body produced while sending, not owned)
+  AsyncHTTPMultipart* multipart   = nullptr;
+
+  // Server-Sent Events (parser kept across reconnects)
+  AsyncHTTPEventParser* events    = nullptr;
+  bool            streamEvents    = false; // 2xx text/event-stream body
+
+  // WebSocket (handshake sent by the slot, then frames; not owned)
+  AsyncHTTPWebSocket* ws          = nullptr;
+
+  // Long polling (re-sent after every response, header block kept)
+  bool            longPoll        = false;
+
+  // Cancellation token (requests tied to it form a list)
+  AsyncHTTPCancelToken* token     = nullptr;
+  AsyncHTTPRequest* tokenPrev     = nullptr;
+  AsyncHTTPRequest* tokenNext     = nullptr;
+
+  // Response cache
+  String          cacheKey;             // "GET <url>" while a cache is set
+  bool            cacheHit        = false; // answered from a fresh entry
+
+  // Connection sharing (keep-alive / pipelining)
+  int8_t          conn            = -1;   // index into the connection pool
+  int8_t          pipeNext        = -1;   // next slot queued on the same socket
+  bool            reissued        = false; // already re-sent after a dropped socket
+  bool            noPipeline      = false; // re-sent requests get their own socket
+
+  // Retry policy
+  uint8_t         attempts        = 0;    // retries made so far
+  unsigned long   retryAt         = 0;    // millis() of the next attempt
+  bool            breakerProbe    = false; // half-open probe of its host
+  bool            rateAdmitted    = false; // token taken for this attempt
+
+  // Readiness (see ASYNC_HTTP_SELECT)
+  bool            drained         = false; // last pass read the socket dry
+  bool            quiet           = false; // select(): nothing new, skip reading
 
   // Callbacks
   typedef void (*ResponseCallback)(const AsyncHTTPResponse& response, void* userData);
   typedef void (*ErrorCallback)(int errorCode, const String& message, void* userData);
+  typedef void (*DataCallback)(const uint8_t* data, size_t len, uint32_t offset,
+                               void* userData);
+  typedef void (*EventCallback)(const char* event, const char* data,
+                                const char* id, void* userData);
+#if ASYNC_HTTP_JSON
+  typedef void (*JsonCallback)(const AsyncHTTPResponse& response,
+                               JsonDocument& doc, void* userData);
+#endif
 
   ResponseCallback onResponseCb   = nullptr;
   void*            onResponseData  = nullptr;
   ErrorCallback    onErrorCb       = nullptr;
   void*            onErrorData     = nullptr;
+  DataCallback     onDataCb        = nullptr;  // set for downloads
+  EventCallback    onEventCb       = nullptr;  // set for event streams
+#if ASYNC_HTTP_JSON
+  JsonCallback     onJsonCb        = nullptr;  // set for JSON responses
+#endif
+
+  // Single-flight: further callbacks for an identical GET
+  struct Waiter {
+    ResponseCallback cb;
+    void*            data;
+  };
+  Waiter           waiters[ASYNC_HTTP_COALESCE_WAITERS];
+  uint8_t          waiterCount     = 0;
 
-  // TCP client – managed by the pool
+  // TCP client – borrowed from the connection pool while attached
   Client*         client          = nullptr;
 
   void reset();
+  void unlinkToken();
+  void resetResponse();
+  void storeBody(const uint8_t* data, size_t len);
+  void flushBody();
+  bool inflateInput(const uint8_t* data, size_t len);
+  void releaseInflate();
+};
+
+// ---------------------------------------------------------------------------
+// AsyncHTTPConnection – one socket of the pool; may outlive a request when
+// keep-alive is enabled, and carry several requests when pipelining
+// ---------------------------------------------------------------------------
+struct AsyncHTTPConnection {
+  Client*         client          = nullptr;
+  bool            owned           = false;  // created by _createClient()
+  bool            open            = false;  // connect() succeeded
+  String          host;                     // peer of the socket
+  uint16_t        port            = 0;
+  bool            tls             = false;
+  bool            pipelinable     = false;  // more GET/HEAD may be queued
+  uint8_t         users           = 0;      // requests written / queued (FIFO)
+  int8_t          head            = -1;     // slot currently owning the read side
+  int8_t          tail            = -1;     // slot written last
+  unsigned long   idleSince       = 0;
+};
+
+// ---------------------------------------------------------------------------
+// AsyncHTTPBreaker – consecutive-failure tracker for one host
+// ---------------------------------------------------------------------------
+struct AsyncHTTPBreaker {
+  String                host;                   // empty = unused
+  AsyncHTTPBreakerState state     = BREAKER_CLOSED;
+  uint8_t               failures  = 0;          // consecutive failures
+  unsigned long         openedAt  = 0;
+  int8_t                probe     = -1;         // slot of the half-open probe
+};
+
+// ---------------------------------------------------------------------------
+// AsyncHTTPRateLimit – token bucket for a host or URL prefix
+// ---------------------------------------------------------------------------
+struct AsyncHTTPRateLimit {
+  String          host;                     // empty = unused
+  String          pathPrefix;               // empty = whole host
+  unsigned long   intervalMs      = 0;      // one token per interval
+  uint8_t         burst           = 1;      // bucket capacity
+  uint8_t         tokens          = 0;
+  unsigned long   lastRefill      = 0;
 };
 
 // ---------------------------------------------------------------------------
@@ -217,6 +561,34 @@ public:
                 AsyncHTTPRequest::ResponseCallback onResponse,
                 void* userData = nullptr);
 
+#if ASYNC_HTTP_JSON
+  /// JSON shorthands for a JsonDocument. The document is serialized
+  /// straight to the socket when the request is sent (Content-Length from
+  /// measureJson()), so it must stay unchanged until the callback.
+  int postJson(const String& url,
+               const JsonDocument& json,
+               AsyncHTTPRequest::ResponseCallback onResponse,
+               void* userData = nullptr);
+
+  int putJson(const String& url,
+              const JsonDocument& json,
+              AsyncHTTPRequest::ResponseCallback onResponse,
+              void* userData = nullptr);
+
+  int patchJson(const String& url,
+                const JsonDocument& json,
+                AsyncHTTPRequest::ResponseCallback onResponse,
+                void* userData = nullptr);
+#endif
+
+  /// HTTP POST of a multipart/form-data body (see AsyncHTTPMultipart).
+  /// The form is read while the request is sent, ASYNC_HTTP_UPLOAD_CHUNK
+  /// bytes per update(), so it and its data must outlive the request.
+  int postMultipart(const String& url,
+                    AsyncHTTPMultipart& form,
+                    AsyncHTTPRequest::ResponseCallback onResponse,
+                    void* userData = nullptr);
+
   /// HTTP DELETE
   int del(const String& url,
           AsyncHTTPRequest::ResponseCallback onResponse,
@@ -232,6 +604,135 @@ public:
               AsyncHTTPRequest::ResponseCallback onResponse,
               void* userData = nullptr);
 
+#if ASYNC_HTTP_JSON
+  // -----------------------------------------------------------------------
+  // JSON responses – the body is collected, then parsed once complete
+  // -----------------------------------------------------------------------
+  /// GET `url` and parse a 2xx body into the JsonDocument passed to
+  /// `onJson` (optionally through an ArduinoJson `filter`, which must
+  /// outlive the request). The decoded body is collected in the response
+  /// buffer and parsed once the whole message has arrived, so update()
+  /// never waits for it; the text is freed as soon as it is parsed. A body
+  /// over ASYNC_HTTP_JSON_BODY_SIZE bytes fails with ASYNC_HTTP_ERR_NO_MEMORY.
+  /// Other statuses arrive with their body and an empty document; invalid
+  /// JSON is reported as ASYNC_HTTP_ERR_PARSE_FAIL.
+  int getJson(const String& url,
+              AsyncHTTPRequest::JsonCallback onJson,
+              void* userData = nullptr);
+
+  int getJson(const String& url,
+              const JsonDocument& filter,
+              AsyncHTTPRequest::JsonCallback onJson,
+              void* userData = nullptr);
+
+  /// Any method with a JSON response (`filter` may be nullptr)
+  int requestJson(AsyncHTTPMethod method,
+                  const String& url,
+                  const String& body,
+                  const String& contentType,
+                  const JsonDocument* filter,
+                  AsyncHTTPRequest::JsonCallback onJson,
+                  void* userData = nullptr);
+#endif
+
+  // -----------------------------------------------------------------------
+  // Downloads – body streamed to onData, resumed after a dropped connection
+  // -----------------------------------------------------------------------
+  /// GET `url` and hand the body to `onData` in pieces of up to
+  /// ASYNC_HTTP_DOWNLOAD_CHUNK bytes with their file offset, instead of
+  /// buffering it. A timeout or dropped connection resumes where it stopped
+  /// (Range + If-Range). `onDone` receives the final response (empty body).
+  /// `onData` may call abort() on its own request.
+  int download(const String& url,
+               AsyncHTTPRequest::DataCallback onData,
+               AsyncHTTPRequest::ResponseCallback onDone,
+               void* userData = nullptr);
+
+  /// Download bytes `from`..`to` (inclusive, `to` = -1: to the end). The
+  /// server must answer 206 with a matching Content-Range.
+  int downloadRange(const String& url, uint32_t from, long to,
+                    AsyncHTTPRequest::DataCallback onData,
+                    AsyncHTTPRequest::ResponseCallback onDone,
+                    void* userData = nullptr);
+
+  /// Split a download of `size` bytes into `parts` ranges fetched on
+  /// separate slots at the same time (limited to the free slots). onData
+  /// calls of different parts interleave; `onDone` runs once, after the
+  /// last part. Returns the id of the first part – abort() of it cancels
+  /// all parts.
+  int downloadParallel(const String& url, uint32_t size, uint8_t parts,
+                       AsyncHTTPRequest::DataCallback onData,
+                       AsyncHTTPRequest::ResponseCallback onDone,
+                       void* userData = nullptr);
+
+  /// End offset (+1) of a running download – its size for download() – or
+  /// -1 while the response headers have not told yet
+  long downloadSize(int requestId) const;
+
+  // -----------------------------------------------------------------------
+  // Server-Sent Events – a long-lived GET parsed into events
+  // -----------------------------------------------------------------------
+  /// Open a text/event-stream at `url`. Every event is passed to `onEvent`
+  /// (type, data and last event id; data longer than
+  /// ASYNC_HTTP_SSE_DATA_SIZE is cut). When the stream ends, fails or stays
+  /// silent for ASYNC_HTTP_SSE_IDLE_TIMEOUT, it is reopened after the
+  /// server's `retry:` delay with Last-Event-ID, until abort(). A non-2xx
+  /// status, 204 or another Content-Type ends it for good: `onClose` then
+  /// receives that response.
+  int sse(const String& url,
+          AsyncHTTPRequest::EventCallback onEvent,
+          AsyncHTTPRequest::ResponseCallback onClose = nullptr,
+          void* userData = nullptr);
+
+  // -----------------------------------------------------------------------
+  // Long polling – one GET re-sent after every response
+  // -----------------------------------------------------------------------
+  /// GET `url` over and over until abort(). Each response goes to
+  /// `onResponse`, then the next request is sent at once on the same
+  /// socket, which is kept alive even without setKeepAlive(). `holdMs`
+  /// replaces the request timeout, so the server may hold a request that
+  /// long. Failed cycles and non-2xx answers are repeated after
+  /// ASYNC_HTTP_LONGPOLL_RETRY.
+  int longPoll(const String& url, unsigned long holdMs,
+               AsyncHTTPRequest::ResponseCallback onResponse,
+               void* userData = nullptr);
+
+  // -----------------------------------------------------------------------
+  // WebSockets – Upgrade handshake through the request slots
+  // -----------------------------------------------------------------------
+  /// Connect `ws` to a ws:// or wss:// (or http/https) URL. The handshake
+  /// uses the connection pool like any request; failures are reported to
+  /// the error callback and then to ws.onClose with code 1006. Once open,
+  /// the slot stays busy until the connection closes; update() receives
+  /// its frames. Calling it for an `ws` already in use drops the old one.
+  int websocket(const String& url, AsyncHTTPWebSocket& ws);
+
+  // -----------------------------------------------------------------------
+  // Batches – several requests with one completion callback
+  // -----------------------------------------------------------------------
+  /// Start the requests of `batch` (see AsyncHTTPBatch.h). As many go out
+  /// as there are free slots, the others follow from update() as slots are
+  /// released. batch.onDone runs from update() once every request has
+  /// finished. False if the batch is empty or already running.
+  bool batch(AsyncHTTPBatch& batch);
+
+  // -----------------------------------------------------------------------
+  // Prepared requests – parse the URL and build the static headers once
+  // -----------------------------------------------------------------------
+  /// Prepare a template for repeated requests to the same endpoint.
+  /// Default headers (setHeader) are captured at this point.
+  bool prepare(AsyncHTTPTemplate& tpl,
+               AsyncHTTPMethod method,
+               const String& url,
+               const String& contentType = "");
+
+  /// Send a request from a prepared template. Only the body and its
+  /// Content-Length are added per call; the template must outlive the request.
+  int send(const AsyncHTTPTemplate& tpl,
+           const String& body,
+           AsyncHTTPRequest::ResponseCallback onResponse,
+           void* userData = nullptr);
+
   // -----------------------------------------------------------------------
   // Per-request / global settings
   // -----------------------------------------------------------------------
@@ -247,17 +748,108 @@ public:
   /// Set an error callback that applies to ALL requests
   void onError(AsyncHTTPRequest::ErrorCallback cb, void* userData = nullptr);
 
+  /// Replace the error callback of one request (e.g. right after starting it)
+  void onError(int requestId, AsyncHTTPRequest::ErrorCallback cb,
+               void* userData = nullptr);
+
+  /// Keep sockets open between requests to the same host (default: off,
+  /// every request sends "Connection: close")
+  void setKeepAlive(bool enable);
+
+  /// Write queued GET/HEAD requests to the same host back-to-back on one
+  /// keep-alive socket; responses are matched in FIFO order. Implies
+  /// keep-alive. `depth` is clamped to ASYNC_HTTP_PIPELINE_DEPTH.
+  void setPipelining(bool enable, uint8_t depth = ASYNC_HTTP_PIPELINE_DEPTH);
+
+  /// Advertise "Accept-Encoding: gzip, deflate" and transparently decode
+  /// compressed responses. `windowSize` bytes are allocated per compressed
+  /// response while it is being received (servers normally need 32768).
+  void setDecompression(bool enable,
+                        size_t windowSize = ASYNC_HTTP_INFLATE_WINDOW);
+
+  /// Send request bodies of at least ASYNC_HTTP_COMPRESS_MIN_SIZE bytes
+  /// gzip-compressed ("Content-Encoding: gzip", chunked transfer). The
+  /// encoder needs 6 × `windowSize` bytes while a body is being sent; if
+  /// that cannot be allocated the body goes out uncompressed.
+  void setCompression(bool enable,
+                      size_t windowSize = ASYNC_HTTP_DEFLATE_WINDOW);
+
+  /// Cache GET responses in `store` (see AsyncHTTPCache.h); nullptr turns
+  /// caching off. Fresh entries (Cache-Control: max-age) are served without
+  /// a request, stale ones are revalidated with If-None-Match /
+  /// If-Modified-Since and a 304 is answered with the cached response.
+  void setCache(AsyncHTTPCacheStore* store);
+
+  /// Single-flight GETs: a get() for a URL that is already in flight adds
+  /// its callback to that request (up to ASYNC_HTTP_COALESCE_WAITERS extra)
+  /// instead of taking a new slot and socket. Every caller receives the same
+  /// response, and they share one request id – abort() cancels all of them.
+  void setCoalescing(bool enable);
+
+  /// Retry transient failures up to `maxAttempts` attempts in total (0/1 =
+  /// off): connect/send failures, timeouts and 429/502/503/504 responses.
+  /// Attempts are spaced by exponential back-off with jitter, or by the
+  /// server's Retry-After; the slot is kept while waiting. Requests that may
+  /// already have reached the server are only retried if idempotent.
+  void setRetry(uint8_t maxAttempts,
+                unsigned long baseDelayMs = ASYNC_HTTP_RETRY_BASE_DELAY,
+                unsigned long maxDelayMs = ASYNC_HTTP_RETRY_MAX_DELAY);
+
+  /// Follow 301/302/303/307/308 redirects up to `maxHops` times (0 = off,
+  /// 3xx responses are delivered as is). 303 – and 301/302 after a POST –
+  /// continue as GET without a body; 307/308 repeat method and body. An
+  /// https → http redirect is only followed if `allowInsecure` is true.
+  void setFollowRedirects(uint8_t maxHops, bool allowInsecure = false);
+
+  /// Open a per-host circuit breaker after `threshold` consecutive failures
+  /// (connect/send errors, timeouts, 502/503/504; 0 = off). While open,
+  /// requests to the host fail at once with ASYNC_HTTP_ERR_CIRCUIT_OPEN;
+  /// after `cooldownMs` a single probe request decides whether it closes.
+  void setCircuitBreaker(uint8_t threshold,
+                         unsigned long cooldownMs = ASYNC_HTTP_BREAKER_COOLDOWN);
+
+  /// Pace requests to a host ("api.example.com") or URL prefix
+  /// ("https://api.example.com/v1/") to one per `intervalMs`, allowing
+  /// bursts of `burst`. A new request to a throttled target is refused with
+  /// ASYNC_HTTP_ERR_RATE_LIMITED before it takes a slot (batch items stay
+  /// queued); retries and redirects wait in STATE_CONNECTING, their timeout
+  /// starting once they go out. `intervalMs` 0 removes the limit.
+  /// Returns false if all ASYNC_HTTP_RATE_LIMITS buckets are in use.
+  bool setRateLimit(const String& match, unsigned long intervalMs,
+                    uint8_t burst = 1);
+
+  /// Breaker state / consecutive failure count of a host (diagnostics)
+  AsyncHTTPBreakerState breakerState(const String& host) const;
+  uint8_t               breakerFailures(const String& host) const;
+
   // -----------------------------------------------------------------------
   // Housekeeping – MUST be called in loop()
   // -----------------------------------------------------------------------
   void update();
 
+  /// Sleep until a socket has data or a request timer is due, at most
+  /// `timeoutMs`; call update() afterwards either way. On ESP32 this blocks
+  /// in lwIP select() on the plain (http/ws) sockets the library created,
+  /// so the CPU can idle. It returns true at once while any request has
+  /// other work (connecting, sending, buffered bytes, TLS or user-supplied
+  /// clients) and on platforms without ASYNC_HTTP_SELECT. False = timed out.
+  bool waitForActivity(unsigned long timeoutMs);
+
   /// Number of in-flight requests
   uint8_t pending() const;
 
-  /// Cancel one request by its id (returned from get/post/…)
+  /// Cancel one request by its id (returned from get/post/…). Ids of
+  /// finished requests are ignored, even once their slot is reused.
   void abort(int requestId);
 
+  /// Tie a running request to `token`; token.cancel() aborts it together
+  /// with the other requests tied to it. False if the request has already
+  /// ended or the token is in use by another AsyncHTTP.
+  bool setCancelToken(int requestId, AsyncHTTPCancelToken& token);
+
+  /// Cancel every request of a running batch; onDone is not called
+  void abort(AsyncHTTPBatch& batch);
+
   /// Cancel all pending requests
   void abortAll();
 
@@ -270,9 +862,42 @@ private:
   // Pool of request slots
   AsyncHTTPRequest _requests[ASYNC_HTTP_MAX_REQUESTS];
 
-  // Internally-owned clients
-  Client*  _ownedClients[ASYNC_HTTP_MAX_REQUESTS];
+  // Socket pool (one per slot; shared by requests when keep-alive is on)
+  AsyncHTTPConnection _conns[ASYNC_HTTP_MAX_REQUESTS];
   bool     _ownsClients = false;
+  bool     _keepAlive   = false;
+  uint8_t  _pipelineDepth = 0;            // 0 = pipelining disabled
+
+  // Response decompression
+  bool     _decompress    = false;
+  size_t   _inflateWindow = ASYNC_HTTP_INFLATE_WINDOW;
+
+  // Request body compression
+  bool     _compress      = false;
+  size_t   _deflateWindow = ASYNC_HTTP_DEFLATE_WINDOW;
+
+  // Response cache (not owned)
+  AsyncHTTPCacheStore* _cache = nullptr;
+
+  // Single-flight GETs
+  bool     _coalesce      = false;
+
+  // Retry policy
+  uint8_t       _retryMax      = 0;       // total attempts, <= 1 = off
+  unsigned long _retryBase     = ASYNC_HTTP_RETRY_BASE_DELAY;
+  unsigned long _retryMaxDelay = ASYNC_HTTP_RETRY_MAX_DELAY;
+
+  // Redirects
+  uint8_t  _maxRedirects      = 0;        // 0 = deliver 3xx as is
+  bool     _redirectInsecure  = false;    // allow https → http
+
+  // Rate limiting
+  AsyncHTTPRateLimit _rateLimits[ASYNC_HTTP_RATE_LIMITS];
+
+  // Circuit breaker
+  AsyncHTTPBreaker _breakers[ASYNC_HTTP_BREAKER_HOSTS];
+  uint8_t       _breakerThreshold = 0;    // 0 = off
+  unsigned long _breakerCooldown  = ASYNC_HTTP_BREAKER_COOLDOWN;
 
   // Default headers
   String   _defaultHeaders;
@@ -284,19 +909,128 @@ private:
   AsyncHTTPRequest::ErrorCallback _globalErrorCb   = nullptr;
   void*                           _globalErrorData  = nullptr;
 
+  // Running batches (linked through AsyncHTTPBatch::_next, not owned)
+  AsyncHTTPBatch* _batches = nullptr;
+
 #if ASYNC_HTTP_SSL_SUPPORT
   bool _insecure = true; // default: allow insecure for ease of use
 #endif
 
+  // Request ids: a sequence number above the slot index, so the id of a
+  // finished request never matches the slot's next request
+  uint32_t _sequence = 0;
+
+  // Slot tracking: a bit per active slot, idle slots on a free list, so
+  // allocation, completion and update() never walk idle slots
+  uint32_t _activeSlots[ASYNC_HTTP_SLOT_WORDS] = {};
+  uint8_t  _activeCount = 0;
+  int8_t   _freeHead    = -1;
+
   // Internals
+  void     _initSlots();
   int      _allocSlot();
+  void     _releaseSlot(AsyncHTTPRequest& req);
+  int8_t   _nextActive(int8_t from) const;
+  int8_t   _slotFor(int requestId) const;
+  int      _joinInFlight(const String& url,
+                         AsyncHTTPRequest::ResponseCallback onResponse,
+                         void* userData);
   bool     _parseUrl(const String& url, String& host, uint16_t& port,
-                     String& path, bool& tls);
-  void     _buildRequestHeader(AsyncHTTPRequest& req, const String& body,
-                                const String& contentType);
+                     String& path, bool& tls);  // copies the parsed spans
+  void     _buildRequestHeader(String& h, AsyncHTTPMethod method,
+                                const String& host, uint16_t port, bool tls,
+                                const String& path, const String& contentType,
+                                bool identity = false);
+  int      _newRequest(AsyncHTTPMethod method, const String& url,
+                       const String& body, const String& contentType,
+                       AsyncHTTPRequest::ResponseCallback onResponse,
+                       void* userData);
+  int      _rejectRequest(int code, const String& message,
+                          AsyncHTTPRequest* req = nullptr);
+  int      _startSlot(AsyncHTTPRequest& req);
+  size_t   _sendRequest(AsyncHTTPRequest& req);
+  void     _sendUpload(AsyncHTTPRequest& req);
   void     _processSlot(AsyncHTTPRequest& req);
+  bool     _parseHeaderLine(AsyncHTTPRequest& req);
+  bool     _bodyIsEmpty(AsyncHTTPRequest& req);
+  int      _feedChunked(AsyncHTTPRequest& req, char c);
+  int      _bodyByte(AsyncHTTPRequest& req, char c);
+  bool     _appendBody(AsyncHTTPRequest& req, char c);
+  bool     _startBody(AsyncHTTPRequest& req);
+  void     _completeBody(AsyncHTTPRequest& req, bool framed);
   void     _finishWithError(AsyncHTTPRequest& req, int code, const String& msg);
-  void     _finishWithResponse(AsyncHTTPRequest& req);
+  void     _finishWithResponse(AsyncHTTPRequest& req, bool framed = false);
+
+  // JSON responses
+#if ASYNC_HTTP_JSON
+  bool     _parseJsonBody(AsyncHTTPRequest& req);
+  int      _sendJson(AsyncHTTPMethod method, const String& url,
+                     const JsonDocument& json,
+                     AsyncHTTPRequest::ResponseCallback onResponse,
+                     void* userData);
+#endif
+
+  // Downloads
+  bool     _startDownload(AsyncHTTPRequest& req);
+  bool     _finishPart(AsyncHTTPRequest& req, bool failed);
+  void     _abortSlot(int8_t i);
+
+  // Server-Sent Events
+  void     _startEvents(AsyncHTTPRequest& req);
+  void     _reconnectEvents(AsyncHTTPRequest& req, bool reusable);
+
+  // Long polling
+  void     _finishPoll(AsyncHTTPRequest& req, bool reusable);
+  void     _rearmPoll(AsyncHTTPRequest& req, bool reusable,
+                      unsigned long delayMs);
+
+  // WebSockets
+  void     _startWebSocket(AsyncHTTPRequest& req);
+  void     _processWebSocket(AsyncHTTPRequest& req);
+  void     _finishWebSocket(AsyncHTTPRequest& req, uint16_t code,
+                            const char* reason);
+
+  // Batches
+  void     _submitBatch(AsyncHTTPBatch& batch);
+  void     _pumpBatches();
+  void     _cancelBatch(AsyncHTTPBatch& batch);
+
+  // Retry policy
+  bool     _retry(AsyncHTTPRequest& req, bool safe, long delayMs,
+                  bool reusable);
+
+  // Redirects
+  bool     _redirect(AsyncHTTPRequest& req, bool reusable);
+
+  // Rate limiting
+  AsyncHTTPRateLimit* _rateBucket(const char* host, const String& path);
+  bool     _rateLimited(const String& url);
+  bool     _rateAllow(AsyncHTTPRequest& req);
+
+  // Circuit breaker
+  AsyncHTTPBreaker* _findBreaker(const char* host) const;
+  bool     _breakerAllow(AsyncHTTPRequest& req);
+  void     _breakerRecord(AsyncHTTPRequest& req, bool failed);
+
+  // Response cache
+  void     _cacheLookup(AsyncHTTPRequest& req, const String& url);
+  void     _cacheResponse(AsyncHTTPRequest& req);
+  void     _fillFromCache(AsyncHTTPRequest& req, const AsyncHTTPCacheEntry& e);
+
+  // Connection pool
+  bool     _attachConnection(AsyncHTTPRequest& req);
+  void     _detachConnection(AsyncHTTPRequest& req, bool reusable);
+  void     _closeConnection(int8_t c, bool failed, int8_t except);
+  bool     _canResend(const AsyncHTTPRequest& req) const;
+  void     _expireIdleConnections();
+  int8_t   _slotOf(const AsyncHTTPRequest& req) const { return req.slot; }
+
+  // Readiness
+#if ASYNC_HTTP_SELECT
+  int      _socketOf(const AsyncHTTPRequest& req) const;
+  int      _watchSockets(fd_set& fds, unsigned long* waitMs);
+  void     _pollSockets();
+#endif
 
   Client*  _createClient(bool tls);
   void     _destroyClient(Client* c, bool tls);
@@ -309,5 +1043,13 @@ private:
 #define ASYNC_HTTP_ERR_TIMEOUT        -4
 #define ASYNC_HTTP_ERR_SEND_FAIL      -5
 #define ASYNC_HTTP_ERR_PARSE_FAIL     -6
+#define ASYNC_HTTP_ERR_NO_MEMORY      -7
+#define ASYNC_HTTP_ERR_CIRCUIT_OPEN   -8
+#define ASYNC_HTTP_ERR_INCOMPLETE     -9
+#define ASYNC_HTTP_ERR_RANGE          -10
+#define ASYNC_HTTP_ERR_OTA_WRITE      -11
+#define ASYNC_HTTP_ERR_OTA_CHECKSUM   -12
+#define ASYNC_HTTP_ERR_UPGRADE        -13
+#define ASYNC_HTTP_ERR_RATE_LIMITED   -14
 
 #endif // ASYNC_HTTP_H
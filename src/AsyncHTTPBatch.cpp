@@ -0,0 +1,86 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#include "AsyncHTTPBatch.h"
+
+// ===========================================================================
+// Building the batch
+// ===========================================================================
+
+AsyncHTTPBatch::~AsyncHTTPBatch() {
+  if (_http) _http->abort(*this);
+}
+
+bool AsyncHTTPBatch::add(AsyncHTTPMethod method, const String& url,
+                         const String& body, const String& contentType) {
+  if (_http || _count >= ASYNC_HTTP_BATCH_SIZE) return false;
+  Item& it       = _items[_count++];
+  it             = Item();
+  it.method      = method;
+  it.url         = url;
+  it.body        = body;
+  it.contentType = contentType;
+  return true;
+}
+
+void AsyncHTTPBatch::clear() {
+  if (_http) return;
+  for (uint8_t i = 0; i < _count; i++) _items[i] = Item();
+  _count = 0;
+}
+
+void AsyncHTTPBatch::onDone(DoneCallback cb, void* userData) {
+  _doneCb   = cb;
+  _doneData = userData;
+}
+
+// ===========================================================================
+// Results
+// ===========================================================================
+
+int AsyncHTTPBatch::status(uint8_t i) const {
+  return i < _count ? _items[i].status : 0;
+}
+
+const String& AsyncHTTPBatch::body(uint8_t i) const {
+  static const String empty;
+  return i < _count ? _items[i].response : empty;
+}
+
+bool AsyncHTTPBatch::succeeded(uint8_t i) const {
+  int code = status(i);
+  return code >= 200 && code < 300;
+}
+
+uint8_t AsyncHTTPBatch::failures() const {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    if (!succeeded(i)) n++;
+  }
+  return n;
+}
+
+// ===========================================================================
+// Request callbacks (userData = the item)
+// ===========================================================================
+
+void AsyncHTTPBatch::_onResponse(const AsyncHTTPResponse& response,
+                                 void* item) {
+  Item& it    = *(Item*)item;
+  it.status   = response.statusCode();
+  it.response = response.body();
+  it.state    = ITEM_DONE;
+}
+
+// The global error callback still hears about batch requests
+void AsyncHTTPBatch::_onError(int code, const String& message, void* item) {
+  Item& it  = *(Item*)item;
+  it.status = code;
+  it.state  = ITEM_DONE;
+  if (it.chainCb) it.chainCb(code, message, it.chainData);
+}
@@ -0,0 +1,98 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#ifndef ASYNC_HTTP_BATCH_H
+#define ASYNC_HTTP_BATCH_H
+
+#include "AsyncHTTP.h"
+
+#ifndef ASYNC_HTTP_BATCH_SIZE
+  #define ASYNC_HTTP_BATCH_SIZE 8           // requests per AsyncHTTPBatch
+#endif
+
+// ---------------------------------------------------------------------------
+// AsyncHTTPBatch – a group of requests with one completion callback
+//
+// AsyncHTTP::batch() sends the requests as slots become free (the rest
+// wait here), so a batch may be larger than the request pool. Requests to
+// the same host share keep-alive sockets and pipelines like any others.
+// Each request's status and body are kept here, and onDone runs once from
+// update() after the last one has finished. The object must outlive the
+// run.
+// ---------------------------------------------------------------------------
+class AsyncHTTPBatch {
+public:
+  typedef void (*DoneCallback)(AsyncHTTPBatch& batch, void* userData);
+
+  AsyncHTTPBatch() {}
+  ~AsyncHTTPBatch();
+
+  /// Add a request (strings are copied). False if the batch is full or
+  /// running.
+  bool add(AsyncHTTPMethod method, const String& url,
+           const String& body = "", const String& contentType = "");
+  bool addGet(const String& url) { return add(HTTP_GET, url); }
+
+  /// Remove all requests and results (not while running)
+  void clear();
+
+  void onDone(DoneCallback cb, void* userData = nullptr);
+
+  /// Send at most `n` requests of the batch at a time (0 = all free slots)
+  void setParallel(uint8_t n) { _parallel = n; }
+
+  /// Cancel the remaining requests as soon as one fails (error or non-2xx);
+  /// onDone then runs at once
+  void setAllOrNothing(bool enable) { _allOrNothing = enable; }
+
+  uint8_t size() const { return _count; }
+  bool    isRunning() const { return _http != nullptr; }
+
+  // ---- Results – valid in onDone and until the batch is started again ----
+
+  /// HTTP status of request `i`, a negative ASYNC_HTTP_ERR_* code, or 0 if
+  /// it was cancelled
+  int           status(uint8_t i) const;
+  const String& body(uint8_t i) const;
+  bool          succeeded(uint8_t i) const;   // 2xx
+  uint8_t       failures() const;             // requests that did not succeed
+  bool          ok() const { return failures() == 0; }
+
+private:
+  friend class AsyncHTTP;
+
+  enum ItemState : uint8_t { ITEM_QUEUED, ITEM_RUNNING, ITEM_DONE };
+
+  struct Item {
+    AsyncHTTPMethod method   = HTTP_GET;
+    String          url;
+    String          body;
+    String          contentType;
+    ItemState       state    = ITEM_QUEUED;
+    int             id       = -1;          // request id while running
+    int             status   = 0;
+    String          response;               // response body
+    AsyncHTTPRequest::ErrorCallback chainCb   = nullptr; // global onError
+    void*                           chainData = nullptr;
+  };
+
+  // ---- Used by AsyncHTTP ----
+  static void _onResponse(const AsyncHTTPResponse& response, void* item);
+  static void _onError(int code, const String& message, void* item);
+
+  AsyncHTTP*      _http         = nullptr;  // set while running
+  AsyncHTTPBatch* _next         = nullptr;  // running batches of _http
+  Item            _items[ASYNC_HTTP_BATCH_SIZE];
+  uint8_t         _count        = 0;
+  uint8_t         _parallel     = 0;
+  bool            _allOrNothing = false;
+  DoneCallback    _doneCb       = nullptr;
+  void*           _doneData     = nullptr;
+};
+
+#endif // ASYNC_HTTP_BATCH_H
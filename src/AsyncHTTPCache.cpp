@@ -0,0 +1,161 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#include "AsyncHTTPCache.h"
+
+// ===========================================================================
+// AsyncHTTPMemoryCache
+// ===========================================================================
+
+bool AsyncHTTPMemoryCache::load(const String& key, AsyncHTTPCacheEntry& entry) {
+  for (uint8_t i = 0; i < ASYNC_HTTP_CACHE_ENTRIES; i++) {
+    if (_slots[i].key.length() > 0 && _slots[i].key == key) {
+      _slots[i].lastUsed = millis();
+      entry = _slots[i].entry;
+      return true;
+    }
+  }
+  return false;
+}
+
+void AsyncHTTPMemoryCache::save(const String& key,
+                                const AsyncHTTPCacheEntry& entry) {
+  // Same key, else an unused slot, else the least recently used one
+  Slot* target = nullptr;
+  for (uint8_t i = 0; i < ASYNC_HTTP_CACHE_ENTRIES && !target; i++) {
+    if (_slots[i].key.length() > 0 && _slots[i].key == key) target = &_slots[i];
+  }
+  for (uint8_t i = 0; i < ASYNC_HTTP_CACHE_ENTRIES && !target; i++) {
+    if (_slots[i].key.length() == 0) target = &_slots[i];
+  }
+  if (!target) {
+    target = &_slots[0];
+    for (uint8_t i = 1; i < ASYNC_HTTP_CACHE_ENTRIES; i++) {
+      if ((long)(_slots[i].lastUsed - target->lastUsed) < 0) target = &_slots[i];
+    }
+  }
+
+  target->key      = key;
+  target->entry    = entry;
+  target->lastUsed = millis();
+}
+
+void AsyncHTTPMemoryCache::remove(const String& key) {
+  for (uint8_t i = 0; i < ASYNC_HTTP_CACHE_ENTRIES; i++) {
+    if (_slots[i].key.length() > 0 && _slots[i].key == key) {
+      _slots[i].key   = "";
+      _slots[i].entry = AsyncHTTPCacheEntry();
+    }
+  }
+}
+
+void AsyncHTTPMemoryCache::clear() {
+  for (uint8_t i = 0; i < ASYNC_HTTP_CACHE_ENTRIES; i++) {
+    _slots[i].key   = "";
+    _slots[i].entry = AsyncHTTPCacheEntry();
+  }
+}
+
+#if ASYNC_HTTP_FILE_CACHE
+// ===========================================================================
+// AsyncHTTPFileCache
+//
+// File layout:  key \n boot stored-at max-age \n status \n etag \n
+//               last-modified \n headers-length \n body-length \n
+//               headers body
+// ===========================================================================
+
+AsyncHTTPFileCache::AsyncHTTPFileCache(fs::FS& fs, const char* dir)
+  : _fs(fs), _dir(dir), _boot(esp_random()) {
+}
+
+// FNV-1a of the key keeps file names short and valid on every file system
+String AsyncHTTPFileCache::_path(const String& key) const {
+  uint32_t h = 2166136261UL;
+  for (unsigned int i = 0; i < key.length(); i++) {
+    h = (h ^ (uint8_t)key[i]) * 16777619UL;
+  }
+  char name[12];
+  snprintf(name, sizeof(name), "/%08lx", (unsigned long)h);
+  return _dir + name;
+}
+
+static bool _readBlock(fs::File& f, String& out, long len) {
+  out = "";
+  if (len < 0 || !out.reserve(len)) return false;
+  char buf[64];
+  while (len > 0) {
+    size_t n = f.read((uint8_t*)buf, len < (long)sizeof(buf) ? len : sizeof(buf));
+    if (n == 0) return false;
+    out.concat(buf, n);
+    len -= n;
+  }
+  return true;
+}
+
+bool AsyncHTTPFileCache::load(const String& key, AsyncHTTPCacheEntry& entry) {
+  fs::File f = _fs.open(_path(key), "r");
+  if (!f) return false;
+
+  bool ok = f.readStringUntil('\n') == key;
+  if (ok) {
+    uint32_t      boot     = strtoul(f.readStringUntil(' ').c_str(), nullptr, 16);
+    unsigned long storedAt = strtoul(f.readStringUntil(' ').c_str(), nullptr, 10);
+    unsigned long maxAge   = strtoul(f.readStringUntil('\n').c_str(), nullptr, 10);
+    entry.statusCode   = f.readStringUntil('\n').toInt();
+    entry.etag         = f.readStringUntil('\n');
+    entry.lastModified = f.readStringUntil('\n');
+    long hdrLen        = f.readStringUntil('\n').toInt();
+    long bodyLen       = f.readStringUntil('\n').toInt();
+    ok = _readBlock(f, entry.headers, hdrLen) &&
+         _readBlock(f, entry.body, bodyLen);
+    // Freshness is only known for entries written since this boot
+    entry.storedAt = (boot == _boot) ? storedAt : millis();
+    entry.maxAgeMs = (boot == _boot) ? maxAge : 0;
+  }
+  f.close();
+  return ok;
+}
+
+void AsyncHTTPFileCache::save(const String& key,
+                              const AsyncHTTPCacheEntry& entry) {
+  if (!_fs.exists(_dir)) _fs.mkdir(_dir);
+
+  fs::File f = _fs.open(_path(key), "w");
+  if (!f) return;
+  char stamp[40];
+  snprintf(stamp, sizeof(stamp), "%08lx %lu %lu\n", (unsigned long)_boot,
+           (unsigned long)entry.storedAt, (unsigned long)entry.maxAgeMs);
+  f.print(key);                       f.print('\n');
+  f.print(stamp);
+  f.print(entry.statusCode);          f.print('\n');
+  f.print(entry.etag);                f.print('\n');
+  f.print(entry.lastModified);        f.print('\n');
+  f.print(entry.headers.length());    f.print('\n');
+  f.print(entry.body.length());       f.print('\n');
+  f.write((const uint8_t*)entry.headers.c_str(), entry.headers.length());
+  f.write((const uint8_t*)entry.body.c_str(), entry.body.length());
+  f.close();
+}
+
+void AsyncHTTPFileCache::remove(const String& key) {
+  String path = _path(key);
+  if (_fs.exists(path)) _fs.remove(path);
+}
+
+void AsyncHTTPFileCache::clear() {
+  fs::File dir = _fs.open(_dir);
+  if (!dir || !dir.isDirectory()) return;
+  for (fs::File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+    String path = f.path();
+    f.close();
+    _fs.remove(path);
+  }
+  dir.close();
+}
+#endif
@@ -0,0 +1,96 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#ifndef ASYNC_HTTP_CACHE_H
+#define ASYNC_HTTP_CACHE_H
+
+#include <Arduino.h>
+
+#if defined(ESP32)
+  #include <FS.h>
+  #define ASYNC_HTTP_FILE_CACHE 1   // LittleFS / SPIFFS / SD via fs::FS
+#else
+  #define ASYNC_HTTP_FILE_CACHE 0
+#endif
+
+#ifndef ASYNC_HTTP_CACHE_ENTRIES
+  #define ASYNC_HTTP_CACHE_ENTRIES   4        // responses kept by AsyncHTTPMemoryCache
+#endif
+
+// ---------------------------------------------------------------------------
+// AsyncHTTPCacheEntry – one stored response plus its freshness/validators
+// ---------------------------------------------------------------------------
+struct AsyncHTTPCacheEntry {
+  int           statusCode   = 0;
+  String        etag;                 // validator for If-None-Match
+  String        lastModified;         // validator for If-Modified-Since
+  String        headers;              // "Name: value\r\n" lines
+  String        body;
+  unsigned long storedAt     = 0;     // millis() when stored / revalidated
+  unsigned long maxAgeMs     = 0;     // freshness lifetime, 0 = always revalidate
+};
+
+// ---------------------------------------------------------------------------
+// AsyncHTTPCacheStore – storage back-end used by AsyncHTTP::setCache()
+// ---------------------------------------------------------------------------
+class AsyncHTTPCacheStore {
+public:
+  virtual ~AsyncHTTPCacheStore() {}
+
+  virtual bool load(const String& key, AsyncHTTPCacheEntry& entry) = 0;
+  virtual void save(const String& key, const AsyncHTTPCacheEntry& entry) = 0;
+  virtual void remove(const String& key) = 0;
+  virtual void clear() = 0;
+};
+
+// ---------------------------------------------------------------------------
+// AsyncHTTPMemoryCache – fixed number of entries in RAM, least recently
+// used entry is replaced first
+// ---------------------------------------------------------------------------
+class AsyncHTTPMemoryCache : public AsyncHTTPCacheStore {
+public:
+  bool load(const String& key, AsyncHTTPCacheEntry& entry) override;
+  void save(const String& key, const AsyncHTTPCacheEntry& entry) override;
+  void remove(const String& key) override;
+  void clear() override;
+
+private:
+  struct Slot {
+    String              key;          // empty = unused
+    AsyncHTTPCacheEntry entry;
+    unsigned long       lastUsed = 0;
+  };
+  Slot _slots[ASYNC_HTTP_CACHE_ENTRIES];
+};
+
+#if ASYNC_HTTP_FILE_CACHE
+// ---------------------------------------------------------------------------
+// AsyncHTTPFileCache – one file per entry in a directory of an fs::FS
+// (LittleFS, SPIFFS, SD). Entries survive a reboot, but millis() does not,
+// so entries written before the current boot are always revalidated.
+// ---------------------------------------------------------------------------
+class AsyncHTTPFileCache : public AsyncHTTPCacheStore {
+public:
+  /// The file system must already be mounted (e.g. LittleFS.begin())
+  AsyncHTTPFileCache(fs::FS& fs, const char* dir = "/httpcache");
+
+  bool load(const String& key, AsyncHTTPCacheEntry& entry) override;
+  void save(const String& key, const AsyncHTTPCacheEntry& entry) override;
+  void remove(const String& key) override;
+  void clear() override;
+
+private:
+  String _path(const String& key) const;
+
+  fs::FS&  _fs;
+  String   _dir;
+  uint32_t _boot;                     // tags entries written since this boot
+};
+#endif
+
+#endif // ASYNC_HTTP_CACHE_H
@@ -0,0 +1,278 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#include "AsyncHTTPDeflate.h"
+
+// ===========================================================================
+// RFC 1951 constant tables
+// ===========================================================================
+
+static const uint16_t kLenBase[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t kLenExtra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t kDistBase[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+  8193, 12289, 16385, 24577
+};
+static const uint8_t kDistExtra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// CRC-32 (gzip), 4 bits at a time to keep the table small
+static const uint32_t kCrcNibble[16] = {
+  0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+  0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+  0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+  0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL
+};
+
+static const uint16_t kMinMatch  = 3;
+static const uint16_t kMaxMatch  = 258;
+static const uint8_t  kMaxChain  = 8;    // hash-chain candidates per position
+
+// ===========================================================================
+// Setup
+// ===========================================================================
+
+AsyncHTTPDeflate::~AsyncHTTPDeflate() {
+  free(_buf);
+}
+
+bool AsyncHTTPDeflate::begin(size_t windowSize, Sink sink, void* ctx) {
+  // Round down to a power of two in 1024..16384 (positions fit in 15 bits)
+  size_t  w    = 1024;
+  uint8_t bits = 10;
+  while (w < 16384 && (w << 1) <= windowSize) {
+    w <<= 1;
+    bits++;
+  }
+
+  free(_buf);
+  _buf = (uint8_t*)malloc(w * 6);
+  if (!_buf) return false;
+  _head = (uint16_t*)(_buf + w * 2);
+  _prev = _head + w;
+  memset(_head, 0, w * 2 * sizeof(uint16_t));
+
+  _windowSize = w;
+  _hashShift  = 32 - bits;
+  _sink   = sink;
+  _ctx    = ctx;
+  _pos    = 0;
+  _end    = 0;
+  _bits   = 0;
+  _nbits  = 0;
+  _outLen = 0;
+  _crc    = 0xFFFFFFFFUL;
+  _size   = 0;
+
+  // gzip member header: deflate, no flags, no mtime, OS unknown
+  static const uint8_t kHeader[10] = {
+    0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF
+  };
+  for (uint8_t i = 0; i < sizeof(kHeader); i++) _putByte(kHeader[i]);
+
+  // Everything goes into one non-final fixed-Huffman block; finish() closes
+  // it with an empty final block
+  _putBits(0, 1);
+  _putBits(1, 2);
+  return true;
+}
+
+// ===========================================================================
+// Input
+// ===========================================================================
+
+void AsyncHTTPDeflate::write(const uint8_t* data, size_t len) {
+  if (!_buf) return;
+
+  for (size_t i = 0; i < len; i++) {
+    _crc ^= data[i];
+    _crc = (_crc >> 4) ^ kCrcNibble[_crc & 0x0F];
+    _crc = (_crc >> 4) ^ kCrcNibble[_crc & 0x0F];
+  }
+  _size += len;
+
+  while (len > 0) {
+    if (_end == _windowSize * 2) _slide();
+
+    size_t n = _windowSize * 2 - _end;
+    if (n > len) n = len;
+    memcpy(_buf + _end, data, n);
+    _end += n;
+    data += n;
+    len  -= n;
+
+    _compress(false);
+  }
+}
+
+void AsyncHTTPDeflate::finish() {
+  if (!_buf) return;
+
+  _compress(true);
+  _putCode(0, 7);                 // end of block
+
+  _putBits(1, 1);                 // empty final block
+  _putBits(1, 2);
+  _putCode(0, 7);
+  if (_nbits > 0) _putBits(0, 8 - _nbits);
+
+  uint32_t crc = _crc ^ 0xFFFFFFFFUL;
+  for (uint8_t i = 0; i < 4; i++) _putByte((uint8_t)(crc >> (8 * i)));
+  for (uint8_t i = 0; i < 4; i++) _putByte((uint8_t)(_size >> (8 * i)));
+  _drain();
+
+  free(_buf);
+  _buf = nullptr;
+}
+
+// ===========================================================================
+// LZ77 – greedy matching over hash chains
+// ===========================================================================
+
+uint32_t AsyncHTTPDeflate::_hash(size_t p) const {
+  uint32_t v = (uint32_t)_buf[p] | ((uint32_t)_buf[p + 1] << 8) |
+               ((uint32_t)_buf[p + 2] << 16);
+  return (uint32_t)(v * 2654435761UL) >> _hashShift;
+}
+
+void AsyncHTTPDeflate::_insert(size_t p) {
+  uint32_t h = _hash(p);
+  _prev[p & (_windowSize - 1)] = _head[h];
+  _head[h] = (uint16_t)(p + 1);
+}
+
+uint16_t AsyncHTTPDeflate::_longestMatch(size_t p, uint16_t& dist) {
+  size_t   limit = _end - p;
+  if (limit > kMaxMatch) limit = kMaxMatch;
+  uint16_t best  = 0;
+  uint16_t cand  = _head[_hash(p)];
+
+  for (uint8_t chain = 0; chain < kMaxChain && cand != 0; chain++) {
+    size_t q = cand - 1;
+    if (q >= p || p - q > _windowSize) break;
+
+    if (_buf[q + best] == _buf[p + best]) {
+      size_t n = 0;
+      while (n < limit && _buf[q + n] == _buf[p + n]) n++;
+      if (n > best) {
+        best = (uint16_t)n;
+        dist = (uint16_t)(p - q);
+        if (n == limit) break;
+      }
+    }
+
+    // Older entries have smaller positions; anything else is stale
+    uint16_t next = _prev[q & (_windowSize - 1)];
+    if (next >= cand) break;
+    cand = next;
+  }
+  return best;
+}
+
+// Encode buffered input. Unless `final`, a full match worth of lookahead
+// is kept back so that matches are never cut short by a write() boundary.
+void AsyncHTTPDeflate::_compress(bool final) {
+  while (_pos < _end && (final || _end - _pos >= kMaxMatch)) {
+    uint16_t len  = 0;
+    uint16_t dist = 0;
+    if (_end - _pos >= kMinMatch) {
+      len = _longestMatch(_pos, dist);
+      _insert(_pos);
+    }
+
+    if (len >= kMinMatch) {
+      _match(len, dist);
+      for (size_t p = _pos + 1; p < _pos + len && p + kMinMatch <= _end; p++) {
+        _insert(p);
+      }
+      _pos += len;
+    } else {
+      _literal(_buf[_pos]);
+      _pos++;
+    }
+  }
+}
+
+// Drop the older half of the buffer and rebase the hash tables
+void AsyncHTTPDeflate::_slide() {
+  size_t w = _windowSize;
+  memmove(_buf, _buf + w, w);
+  _pos -= w;
+  _end -= w;
+  for (size_t i = 0; i < w; i++) {
+    _head[i] = (_head[i] > w) ? (uint16_t)(_head[i] - w) : 0;
+    _prev[i] = (_prev[i] > w) ? (uint16_t)(_prev[i] - w) : 0;
+  }
+}
+
+// ===========================================================================
+// Output – fixed Huffman codes (RFC 1951 §3.2.6)
+// ===========================================================================
+
+void AsyncHTTPDeflate::_putBits(uint32_t value, uint8_t n) {
+  _bits  |= value << _nbits;
+  _nbits += n;
+  while (_nbits >= 8) {
+    _putByte((uint8_t)_bits);
+    _bits  >>= 8;
+    _nbits  -= 8;
+  }
+}
+
+void AsyncHTTPDeflate::_putCode(uint16_t code, uint8_t n) {
+  uint16_t rev = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    rev = (rev << 1) | (code & 1);
+    code >>= 1;
+  }
+  _putBits(rev, n);
+}
+
+void AsyncHTTPDeflate::_literal(uint8_t b) {
+  if (b < 144) {
+    _putCode(0x30 + b, 8);
+  } else {
+    _putCode(0x190 + (b - 144), 9);
+  }
+}
+
+void AsyncHTTPDeflate::_match(uint16_t len, uint16_t dist) {
+  uint8_t i = 28;
+  while (kLenBase[i] > len) i--;
+  uint16_t sym = 257 + i;
+  if (sym < 280) {
+    _putCode(sym - 256, 7);
+  } else {
+    _putCode(0xC0 + (sym - 280), 8);
+  }
+  _putBits(len - kLenBase[i], kLenExtra[i]);
+
+  uint8_t d = 29;
+  while (kDistBase[d] > dist) d--;
+  _putCode(d, 5);
+  _putBits(dist - kDistBase[d], kDistExtra[d]);
+}
+
+void AsyncHTTPDeflate::_putByte(uint8_t b) {
+  _out[_outLen++] = b;
+  if (_outLen == sizeof(_out)) _drain();
+}
+
+void AsyncHTTPDeflate::_drain() {
+  if (_outLen > 0 && _sink) _sink(_ctx, _out, _outLen);
+  _outLen = 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#ifndef ASYNC_HTTP_DEFLATE_H
+#define ASYNC_HTTP_DEFLATE_H
+
+#include <Arduino.h>
+
+// ---------------------------------------------------------------------------
+// AsyncHTTPDeflate – streaming gzip encoder (LZ77 + fixed Huffman codes)
+//
+// Plain bytes are pushed with write(); compressed bytes are handed to the
+// sink in pieces of at most 256 bytes. Working memory is 6 × windowSize
+// bytes (history buffer, hash heads and hash chains), allocated in begin().
+// ---------------------------------------------------------------------------
+class AsyncHTTPDeflate {
+public:
+  typedef void (*Sink)(void* ctx, const uint8_t* data, size_t len);
+
+  AsyncHTTPDeflate() {}
+  ~AsyncHTTPDeflate();
+
+  /// Allocate the working memory (window is a power of two, 1024..16384)
+  /// and emit the gzip header. Returns false if the allocation fails.
+  bool begin(size_t windowSize, Sink sink, void* ctx);
+
+  /// Compress `len` more bytes
+  void write(const uint8_t* data, size_t len);
+
+  /// Encode the remaining input and emit the gzip trailer
+  void finish();
+
+private:
+  void _compress(bool final);
+  void _slide();
+  void _insert(size_t p);
+  uint16_t _longestMatch(size_t p, uint16_t& dist);
+  uint32_t _hash(size_t p) const;
+
+  void _putBits(uint32_t value, uint8_t n);
+  void _putCode(uint16_t code, uint8_t n);   // Huffman code, MSB first
+  void _literal(uint8_t b);
+  void _match(uint16_t len, uint16_t dist);
+  void _putByte(uint8_t b);
+  void _drain();
+
+  Sink      _sink       = nullptr;
+  void*     _ctx        = nullptr;
+
+  // Working memory (one allocation)
+  uint8_t*  _buf        = nullptr;   // 2 × window: history + lookahead
+  uint16_t* _head       = nullptr;   // hash → most recent position + 1
+  uint16_t* _prev       = nullptr;   // position → previous one with same hash
+  size_t    _windowSize = 0;
+  uint8_t   _hashShift  = 0;
+
+  size_t    _pos        = 0;         // next byte to encode
+  size_t    _end        = 0;         // bytes held in _buf
+
+  // Output bit buffer (LSB first)
+  uint32_t  _bits       = 0;
+  uint8_t   _nbits      = 0;
+  uint8_t   _out[256];
+  uint16_t  _outLen     = 0;
+
+  // gzip trailer
+  uint32_t  _crc        = 0xFFFFFFFFUL;
+  uint32_t  _size       = 0;
+};
+
+#endif // ASYNC_HTTP_DEFLATE_H
@@ -0,0 +1,151 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#include "AsyncHTTPEvents.h"
+
+AsyncHTTPEventParser::AsyncHTTPEventParser() {
+  _event[0] = '\0';
+  _data[0]  = '\0';
+  _id[0]    = '\0';
+}
+
+void AsyncHTTPEventParser::discard() {
+  _field      = FIELD_NAME;
+  _nameLen    = 0;
+  _skipSpace  = false;
+  _cr         = false;
+  _eventLen   = 0;
+  _dataLen    = 0;
+  _dispatched = false;
+}
+
+// Lines end with CRLF, LF or CR
+bool AsyncHTTPEventParser::feed(char c) {
+  if (_dispatched) {
+    _eventLen   = 0;
+    _dataLen    = 0;
+    _dispatched = false;
+  }
+  if (_cr) {
+    _cr = false;
+    if (c == '\n') return false;
+  }
+  if (c == '\r') {
+    _cr = true;
+    return _endLine();
+  }
+  if (c == '\n') return _endLine();
+
+  if (_field == FIELD_NAME) {
+    if (c == ':') {
+      _startValue();
+    } else if (_nameLen < sizeof(_name)) {
+      _name[_nameLen++] = c;
+    } else {
+      _field = FIELD_IGNORE;            // longer than any known field
+    }
+    return false;
+  }
+  if (_skipSpace) {
+    _skipSpace = false;
+    if (c == ' ') return false;
+  }
+  _value(c);
+  return false;
+}
+
+// Field name complete (a line starting with ':' is a comment)
+void AsyncHTTPEventParser::_startValue() {
+  _skipSpace = true;
+  _field     = FIELD_IGNORE;
+  if (_nameLen == 5 && memcmp(_name, "event", 5) == 0) {
+    _field    = FIELD_EVENT;
+    _eventLen = 0;
+  } else if (_nameLen == 4 && memcmp(_name, "data", 4) == 0) {
+    _field    = FIELD_DATA;
+  } else if (_nameLen == 2 && memcmp(_name, "id", 2) == 0) {
+    _field    = FIELD_ID;
+    _idLen    = 0;
+    _idValid  = true;
+  } else if (_nameLen == 5 && memcmp(_name, "retry", 5) == 0) {
+    _field      = FIELD_RETRY;
+    _retryBuf   = 0;
+    _retryValid = false;
+  }
+}
+
+// Values that do not fit are cut; an id that does not fit is ignored
+void AsyncHTTPEventParser::_value(char c) {
+  switch (_field) {
+    case FIELD_EVENT:
+      if (_eventLen < sizeof(_event) - 1) _event[_eventLen++] = c;
+      break;
+    case FIELD_DATA:
+      if (_dataLen < sizeof(_data) - 1) _data[_dataLen++] = c;
+      break;
+    case FIELD_ID:
+      if (c == '\0' || _idLen >= sizeof(_idBuf) - 1) {
+        _idValid = false;
+      } else {
+        _idBuf[_idLen++] = c;
+      }
+      break;
+    case FIELD_RETRY:
+      if (c >= '0' && c <= '9' && _retryBuf < 100000000UL) {
+        _retryBuf   = _retryBuf * 10 + (c - '0');
+        _retryValid = true;
+      } else {
+        _field = FIELD_IGNORE;          // not a plain number
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+bool AsyncHTTPEventParser::_endLine() {
+  bool dispatch = false;
+  if (_field == FIELD_NAME) {
+    if (_nameLen == 0) {
+      // Blank line: dispatch, unless no data line was seen
+      if (_dataLen > 0) {
+        if (_data[_dataLen - 1] == '\n') _dataLen--;
+        _data[_dataLen]   = '\0';
+        _event[_eventLen] = '\0';
+        _dispatched = true;
+        dispatch    = true;
+      } else {
+        _eventLen = 0;
+      }
+    } else {
+      _startValue();                    // field without colon: empty value
+    }
+  }
+
+  switch (_field) {
+    case FIELD_DATA:
+      if (_dataLen < sizeof(_data) - 1) _data[_dataLen++] = '\n';
+      break;
+    case FIELD_ID:
+      if (_idValid) {
+        memcpy(_id, _idBuf, _idLen);
+        _id[_idLen] = '\0';
+      }
+      break;
+    case FIELD_RETRY:
+      if (_retryValid) _retry = _retryBuf;
+      break;
+    default:
+      break;
+  }
+
+  _field     = FIELD_NAME;
+  _nameLen   = 0;
+  _skipSpace = false;
+  return dispatch;
+}
@@ -0,0 +1,83 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#ifndef ASYNC_HTTP_EVENTS_H
+#define ASYNC_HTTP_EVENTS_H
+
+#include <Arduino.h>
+
+#ifndef ASYNC_HTTP_SSE_DATA_SIZE
+  #define ASYNC_HTTP_SSE_DATA_SIZE   1024     // event data bytes kept (longer is cut)
+#endif
+
+#ifndef ASYNC_HTTP_SSE_EVENT_SIZE
+  #define ASYNC_HTTP_SSE_EVENT_SIZE  32       // event type bytes kept
+#endif
+
+#ifndef ASYNC_HTTP_SSE_ID_SIZE
+  #define ASYNC_HTTP_SSE_ID_SIZE     64       // event id bytes kept
+#endif
+
+// ---------------------------------------------------------------------------
+// AsyncHTTPEventParser – incremental text/event-stream parser
+//
+// Bytes are fed one at a time; `event:`, `data:`, `id:` and `retry:` fields
+// go straight into fixed buffers, so no line is ever buffered. feed()
+// returns true when a blank line completes an event, which can then be read
+// until the next feed().
+// ---------------------------------------------------------------------------
+class AsyncHTTPEventParser {
+public:
+  AsyncHTTPEventParser();
+
+  /// One byte of the stream. Returns true when it completed an event.
+  bool feed(char c);
+
+  /// Forget a partly received event (after a dropped connection); the last
+  /// event id and retry delay are kept
+  void discard();
+
+  const char* event()  const { return _eventLen ? _event : "message"; }
+  const char* data()   const { return _data; }
+  const char* lastId() const { return _id; }
+  /// Reconnection delay sent by the server (`retry:`), 0 = none
+  uint32_t    retry()  const { return _retry; }
+
+private:
+  enum Field : uint8_t { FIELD_NAME, FIELD_EVENT, FIELD_DATA, FIELD_ID,
+                         FIELD_RETRY, FIELD_IGNORE };
+
+  void _startValue();
+  void _value(char c);
+  bool _endLine();
+
+  // Current line
+  Field    _field     = FIELD_NAME;
+  char     _name[6];                  // longest field name is "retry"
+  uint8_t  _nameLen   = 0;
+  bool     _skipSpace = false;        // one space after the colon is dropped
+  bool     _cr        = false;        // CR seen, a following LF is skipped
+  char     _idBuf[ASYNC_HTTP_SSE_ID_SIZE];
+  uint8_t  _idLen     = 0;
+  bool     _idValid   = true;
+  uint32_t _retryBuf  = 0;
+  bool     _retryValid = false;
+
+  // Current event
+  char     _event[ASYNC_HTTP_SSE_EVENT_SIZE];
+  uint8_t  _eventLen  = 0;
+  char     _data[ASYNC_HTTP_SSE_DATA_SIZE];
+  uint16_t _dataLen   = 0;
+  bool     _dispatched = false;       // buffers still hold the last event
+
+  // Kept across events and reconnects
+  char     _id[ASYNC_HTTP_SSE_ID_SIZE];
+  uint32_t _retry     = 0;
+};
+
+#endif // ASYNC_HTTP_EVENTS_H
@@ -0,0 +1,486 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#include "AsyncHTTPInflate.h"
+
+// ===========================================================================
+// RFC 1951 constant tables
+// ===========================================================================
+
+static const uint16_t kLenBase[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t kLenExtra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t kDistBase[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+  8193, 12289, 16385, 24577
+};
+static const uint8_t kDistExtra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+static const uint8_t kClenOrder[19] = {
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+// CRC-32 (gzip), 4 bits at a time to keep the table small
+static const uint32_t kCrcNibble[16] = {
+  0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+  0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+  0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+  0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL
+};
+
+static uint32_t _le32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+         ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// ===========================================================================
+// Setup
+// ===========================================================================
+
+AsyncHTTPInflate::~AsyncHTTPInflate() {
+  free(_window);
+}
+
+bool AsyncHTTPInflate::begin(Format format, size_t windowSize,
+                             Sink sink, void* ctx) {
+  // Round down to a power of two in 256..32768
+  size_t w = 256;
+  while (w < 32768 && (w << 1) <= windowSize) w <<= 1;
+
+  if (_window && _windowSize != w) {
+    free(_window);
+    _window = nullptr;
+  }
+  if (!_window) {
+    _window = (uint8_t*)malloc(w);
+    if (!_window) return false;
+  }
+  _windowSize = w;
+
+  _format  = format;
+  _state   = (format == FORMAT_GZIP) ? S_GZ_HEADER : S_ZLIB_HEADER;
+  _sink    = sink;
+  _ctx     = ctx;
+  _bits    = 0;
+  _nbits   = 0;
+  _pos     = 0;
+  _flushed = 0;
+  _final   = false;
+  _flags   = 0;
+  _count   = 0;
+  _crc     = 0xFFFFFFFFUL;
+  _adlerA  = 1;
+  _adlerB  = 0;
+  _zlib    = false;
+  return true;
+}
+
+// ===========================================================================
+// Input
+// ===========================================================================
+
+AsyncHTTPInflate::Result AsyncHTTPInflate::write(const uint8_t* data,
+                                                 size_t len) {
+  size_t i = 0;
+  while (_state != S_DONE && _state != S_ERROR) {
+    // Top up the bit buffer (never more than 32 bits)
+    while (_nbits <= 24 && i < len) {
+      _bits  |= (uint32_t)data[i++] << _nbits;
+      _nbits += 8;
+    }
+
+    StepResult r = _step();
+    if (r == STEP_MORE) {
+      if (i >= len) break;          // wait for the next write()
+      if (_nbits > 24) _fail();     // no step needs more than 24 bits
+    }
+  }
+
+  if (_state == S_ERROR) return INFLATE_ERROR;
+  return (_state == S_DONE) ? INFLATE_FINISHED : INFLATE_MORE;
+}
+
+uint32_t AsyncHTTPInflate::_take(uint8_t n) {
+  if (n == 0) return 0;
+  uint32_t v = _bits & ((1UL << n) - 1);
+  _bits  >>= n;
+  _nbits  -= n;
+  return v;
+}
+
+// ===========================================================================
+// Huffman trees (canonical, counts + sorted symbols)
+// ===========================================================================
+
+bool AsyncHTTPInflate::_build(Tree& t, const uint8_t* lengths, uint16_t num) {
+  uint16_t offs[16];
+  memset(t.counts, 0, sizeof(t.counts));
+  for (uint16_t i = 0; i < num; i++) t.counts[lengths[i]]++;
+  t.counts[0] = 0;
+
+  // Reject over-subscribed code sets
+  int32_t left = 1;
+  for (uint8_t len = 1; len < 16; len++) {
+    left = (left << 1) - t.counts[len];
+    if (left < 0) return false;
+  }
+
+  uint16_t sum = 0;
+  for (uint8_t len = 0; len < 16; len++) {
+    offs[len] = sum;
+    sum += t.counts[len];
+  }
+  for (uint16_t i = 0; i < num; i++) {
+    if (lengths[i]) t.symbols[offs[lengths[i]]++] = i;
+  }
+  return true;
+}
+
+void AsyncHTTPInflate::_buildFixed() {
+  uint16_t i = 0;
+  for (; i < 144; i++) _lengths[i] = 8;
+  for (; i < 256; i++) _lengths[i] = 9;
+  for (; i < 280; i++) _lengths[i] = 7;
+  for (; i < 288; i++) _lengths[i] = 8;
+  _build(_lit, _lengths, 288);
+
+  for (i = 0; i < 30; i++) _lengths[i] = 5;
+  _build(_dist, _lengths, 30);
+}
+
+// Decode one symbol without consuming anything unless it is complete
+int AsyncHTTPInflate::_decode(const Tree& t) {
+  int32_t sum = 0, cur = 0;
+  for (uint8_t len = 1; len < 16; len++) {
+    if (len > _nbits) return -1;
+    cur  = 2 * cur + (int32_t)((_bits >> (len - 1)) & 1);
+    sum += t.counts[len];
+    cur -= t.counts[len];
+    if (cur < 0) {
+      _take(len);
+      return t.symbols[sum + cur];
+    }
+  }
+  return -2;
+}
+
+// ===========================================================================
+// Output
+// ===========================================================================
+
+void AsyncHTTPInflate::_put(uint8_t b) {
+  _window[_pos & (_windowSize - 1)] = b;
+  _pos++;
+  if (_pos - _flushed == _windowSize) _flush();
+}
+
+bool AsyncHTTPInflate::_copy(uint16_t len, uint16_t dist) {
+  if (dist > _pos || dist > _windowSize) return false;
+  size_t mask = _windowSize - 1;
+  while (len--) {
+    _put(_window[(_pos - dist) & mask]);
+  }
+  return true;
+}
+
+void AsyncHTTPInflate::_flush() {
+  size_t n = _pos - _flushed;
+  if (n == 0) return;
+
+  size_t start = _flushed & (_windowSize - 1);
+  size_t first = _windowSize - start;
+  if (first > n) first = n;
+
+  const uint8_t* spans[2] = { _window + start, _window };
+  size_t         lens[2]  = { first, n - first };
+  for (uint8_t s = 0; s < 2; s++) {
+    const uint8_t* p = spans[s];
+    size_t         k = lens[s];
+    if (k == 0) continue;
+
+    if (_format == FORMAT_GZIP) {
+      for (size_t i = 0; i < k; i++) {
+        _crc ^= p[i];
+        _crc = (_crc >> 4) ^ kCrcNibble[_crc & 0x0F];
+        _crc = (_crc >> 4) ^ kCrcNibble[_crc & 0x0F];
+      }
+    } else if (_zlib) {
+      for (size_t i = 0; i < k; i++) {
+        _adlerA += p[i];
+        if (_adlerA >= 65521UL) _adlerA -= 65521UL;
+        _adlerB += _adlerA;
+        if (_adlerB >= 65521UL) _adlerB -= 65521UL;
+      }
+    }
+    if (_sink && !_sink(_ctx, p, k)) _sink = nullptr;
+  }
+  _flushed = _pos;
+}
+
+// ===========================================================================
+// Decoder state machine – every step either completes atomically or
+// returns STEP_MORE without consuming input
+// ===========================================================================
+
+AsyncHTTPInflate::StepResult AsyncHTTPInflate::_step() {
+  switch (_state) {
+
+    // ---- gzip member header (RFC 1952) ----
+    case S_GZ_HEADER: {
+      if (!_have(8)) return STEP_MORE;
+      uint8_t b = (uint8_t)_take(8);
+      switch (_count++) {
+        case 0: if (b != 0x1F) return _fail(); break;
+        case 1: if (b != 0x8B) return _fail(); break;
+        case 2: if (b != 8)    return _fail(); break;  // CM = deflate
+        case 3: _flags = b; if (b & 0xE0) return _fail(); break;
+        default: break;                                // MTIME, XFL, OS
+      }
+      if (_count == 10) {
+        _count = 0;
+        _state = S_GZ_EXTRA_LEN;
+      }
+      return STEP_OK;
+    }
+
+    case S_GZ_EXTRA_LEN:
+      if (!(_flags & 0x04)) { _state = S_GZ_NAME; return STEP_OK; }
+      if (!_have(16)) return STEP_MORE;
+      _remaining = (uint16_t)_take(16);
+      _state = S_GZ_EXTRA;
+      return STEP_OK;
+
+    case S_GZ_EXTRA:
+      if (_remaining == 0) { _state = S_GZ_NAME; return STEP_OK; }
+      if (!_have(8)) return STEP_MORE;
+      _take(8);
+      _remaining--;
+      return STEP_OK;
+
+    case S_GZ_NAME:
+    case S_GZ_COMMENT: {
+      uint8_t flag = (_state == S_GZ_NAME) ? 0x08 : 0x10;
+      State   next = (_state == S_GZ_NAME) ? S_GZ_COMMENT : S_GZ_HCRC;
+      if (!(_flags & flag)) { _state = next; return STEP_OK; }
+      if (!_have(8)) return STEP_MORE;
+      if (_take(8) == 0) _state = next;   // zero-terminated
+      return STEP_OK;
+    }
+
+    case S_GZ_HCRC:
+      if (_flags & 0x02) {
+        if (!_have(16)) return STEP_MORE;
+        _take(16);
+      }
+      _state = S_BLOCK_HEADER;
+      return STEP_OK;
+
+    // ---- zlib header (RFC 1950); without one, raw deflate is assumed ----
+    case S_ZLIB_HEADER: {
+      if (!_have(16)) return STEP_MORE;
+      uint8_t cmf = (uint8_t)(_bits & 0xFF);
+      uint8_t flg = (uint8_t)((_bits >> 8) & 0xFF);
+      if ((cmf & 0x0F) == 8 && (cmf >> 4) <= 7 &&
+          (((uint16_t)cmf << 8) | flg) % 31 == 0 && !(flg & 0x20)) {
+        if ((1UL << ((cmf >> 4) + 8)) > _windowSize) return _fail();
+        _take(16);
+        _zlib = true;
+      }
+      _state = S_BLOCK_HEADER;
+      return STEP_OK;
+    }
+
+    // ---- Deflate blocks (RFC 1951) ----
+    case S_BLOCK_HEADER: {
+      if (!_have(3)) return STEP_MORE;
+      _final = _take(1);
+      switch (_take(2)) {
+        case 0:
+          _take(_nbits & 7);               // stored: skip to byte boundary
+          _state = S_STORED_LEN;
+          break;
+        case 1:
+          _buildFixed();
+          _state = S_SYMBOL;
+          break;
+        case 2:
+          _state = S_DYN_HEADER;
+          break;
+        default:
+          return _fail();
+      }
+      return STEP_OK;
+    }
+
+    case S_STORED_LEN: {
+      if (!_have(32)) return STEP_MORE;
+      uint16_t len  = (uint16_t)_take(16);
+      uint16_t nlen = (uint16_t)_take(16);
+      if (len != (uint16_t)~nlen) return _fail();
+      _remaining = len;
+      _state = S_STORED_DATA;
+      return STEP_OK;
+    }
+
+    case S_STORED_DATA:
+      if (_remaining == 0) break;          // end of block
+      if (!_have(8)) return STEP_MORE;
+      _put((uint8_t)_take(8));
+      _remaining--;
+      return STEP_OK;
+
+    case S_DYN_HEADER:
+      if (!_have(14)) return STEP_MORE;
+      _hlit  = (uint16_t)_take(5) + 257;
+      _hdist = (uint16_t)_take(5) + 1;
+      _hclen = (uint8_t)_take(4) + 4;
+      if (_hlit > 286 || _hdist > 30) return _fail();
+      memset(_lengths, 0, 19);
+      _count = 0;
+      _state = S_DYN_CLEN;
+      return STEP_OK;
+
+    case S_DYN_CLEN:
+      if (_count < _hclen) {
+        if (!_have(3)) return STEP_MORE;
+        _lengths[kClenOrder[_count++]] = (uint8_t)_take(3);
+        return STEP_OK;
+      }
+      // The code-length tree is built into _lit until the real one is read
+      if (!_build(_lit, _lengths, 19)) return _fail();
+      memset(_lengths, 0, sizeof(_lengths));
+      _count = 0;
+      _state = S_DYN_LENS;
+      return STEP_OK;
+
+    case S_DYN_LENS: {
+      if (_count < _hlit + _hdist) {
+        int sym = _decode(_lit);
+        if (sym == -1) return STEP_MORE;
+        if (sym < 0) return _fail();
+        if (sym < 16) {
+          _lengths[_count++] = (uint8_t)sym;
+        } else {
+          _sym   = (uint16_t)sym;
+          _state = S_DYN_LENS_EXTRA;
+        }
+        return STEP_OK;
+      }
+      if (_lengths[256] == 0) return _fail();    // no end-of-block code
+      if (!_build(_lit, _lengths, _hlit) ||
+          !_build(_dist, _lengths + _hlit, _hdist)) {
+        return _fail();
+      }
+      _state = S_SYMBOL;
+      return STEP_OK;
+    }
+
+    case S_DYN_LENS_EXTRA: {
+      uint8_t  bits = (_sym == 16) ? 2 : (_sym == 17) ? 3 : 7;
+      if (!_have(bits)) return STEP_MORE;
+      uint16_t rep  = (uint16_t)_take(bits) + ((_sym == 18) ? 11 : 3);
+      uint8_t  val  = 0;
+      if (_sym == 16) {
+        if (_count == 0) return _fail();
+        val = _lengths[_count - 1];
+      }
+      if (_count + rep > _hlit + _hdist) return _fail();
+      while (rep--) _lengths[_count++] = val;
+      _state = S_DYN_LENS;
+      return STEP_OK;
+    }
+
+    case S_SYMBOL: {
+      int sym = _decode(_lit);
+      if (sym == -1) return STEP_MORE;
+      if (sym < 0 || sym > 285) return _fail();
+      if (sym < 256) {
+        _put((uint8_t)sym);
+        return STEP_OK;
+      }
+      if (sym == 256) break;               // end of block
+      _sym   = (uint16_t)(sym - 257);
+      _state = S_LEN_EXTRA;
+      return STEP_OK;
+    }
+
+    case S_LEN_EXTRA:
+      if (!_have(kLenExtra[_sym])) return STEP_MORE;
+      _len   = kLenBase[_sym] + (uint16_t)_take(kLenExtra[_sym]);
+      _state = S_DIST_SYMBOL;
+      return STEP_OK;
+
+    case S_DIST_SYMBOL: {
+      int sym = _decode(_dist);
+      if (sym == -1) return STEP_MORE;
+      if (sym < 0 || sym >= 30) return _fail();
+      _sym   = (uint16_t)sym;
+      _state = S_DIST_EXTRA;
+      return STEP_OK;
+    }
+
+    case S_DIST_EXTRA: {
+      if (!_have(kDistExtra[_sym])) return STEP_MORE;
+      uint16_t dist = kDistBase[_sym] + (uint16_t)_take(kDistExtra[_sym]);
+      if (!_copy(_len, dist)) return _fail();   // before start / past window
+      _state = S_SYMBOL;
+      return STEP_OK;
+    }
+
+    // ---- Trailer: gzip CRC-32 + ISIZE, zlib Adler-32 ----
+    case S_TRAILER: {
+      uint8_t need = (_format == FORMAT_GZIP) ? 8 : 4;
+      if (_count < need) {
+        if (!_have(8)) return STEP_MORE;
+        _trailer[_count++] = (uint8_t)_take(8);
+        return STEP_OK;
+      }
+      bool ok;
+      if (_format == FORMAT_GZIP) {
+        ok = _le32(_trailer) == (_crc ^ 0xFFFFFFFFUL) &&
+             _le32(_trailer + 4) == _pos;
+      } else {
+        uint32_t adler = ((uint32_t)_trailer[0] << 24) |
+                         ((uint32_t)_trailer[1] << 16) |
+                         ((uint32_t)_trailer[2] << 8) | _trailer[3];
+        ok = adler == ((_adlerB << 16) | _adlerA);
+      }
+      if (!ok) return _fail();
+      _state = S_DONE;
+      return STEP_STOP;
+    }
+
+    case S_DONE:
+    case S_ERROR:
+    default:
+      return STEP_STOP;
+  }
+
+  // ---- End of a deflate block ----
+  if (!_final) {
+    _state = S_BLOCK_HEADER;
+    return STEP_OK;
+  }
+  _take(_nbits & 7);                       // trailer is byte aligned
+  _flush();                                // checksum covers all output
+  if (_format == FORMAT_DEFLATE && !_zlib) {
+    _state = S_DONE;                       // raw deflate has no trailer
+    return STEP_STOP;
+  }
+  _count = 0;
+  _state = S_TRAILER;
+  return STEP_OK;
+}
@@ -0,0 +1,116 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#ifndef ASYNC_HTTP_INFLATE_H
+#define ASYNC_HTTP_INFLATE_H
+
+#include <Arduino.h>
+
+// ---------------------------------------------------------------------------
+// AsyncHTTPInflate – streaming gzip / zlib / raw deflate decoder
+//
+// Compressed bytes are pushed in arbitrary pieces with write(); decoded
+// bytes are handed to the sink as they become available. The only large
+// allocation is the history window, whose size is fixed at begin().
+// ---------------------------------------------------------------------------
+class AsyncHTTPInflate {
+public:
+  enum Format {
+    FORMAT_GZIP = 0,     // Content-Encoding: gzip / x-gzip
+    FORMAT_DEFLATE       // Content-Encoding: deflate (zlib, or raw deflate)
+  };
+
+  enum Result {
+    INFLATE_ERROR    = -1,
+    INFLATE_MORE     = 0,  // stream not finished yet
+    INFLATE_FINISHED = 1   // end of stream and checksum verified
+  };
+
+  /// Receives decoded bytes; returning false drops all further output
+  typedef bool (*Sink)(void* ctx, const uint8_t* data, size_t len);
+
+  AsyncHTTPInflate() {}
+  ~AsyncHTTPInflate();
+
+  /// Allocate the window (a power of two, 256..32768) and reset the decoder.
+  /// Returns false if the window cannot be allocated.
+  bool begin(Format format, size_t windowSize, Sink sink, void* ctx);
+
+  /// Feed compressed bytes. Output is passed to the sink whenever the window
+  /// fills up and at the end of the stream; call flush() to force it.
+  Result write(const uint8_t* data, size_t len);
+  void   flush() { if (_window) _flush(); }
+
+  bool finished() const { return _state == S_DONE; }
+  bool failed()   const { return _state == S_ERROR; }
+
+private:
+  struct Tree {
+    uint16_t counts[16];
+    uint16_t symbols[288];
+  };
+
+  enum State : uint8_t {
+    S_GZ_HEADER = 0, S_GZ_EXTRA_LEN, S_GZ_EXTRA, S_GZ_NAME, S_GZ_COMMENT,
+    S_GZ_HCRC, S_ZLIB_HEADER, S_BLOCK_HEADER, S_STORED_LEN, S_STORED_DATA,
+    S_DYN_HEADER, S_DYN_CLEN, S_DYN_LENS, S_DYN_LENS_EXTRA, S_SYMBOL,
+    S_LEN_EXTRA, S_DIST_SYMBOL, S_DIST_EXTRA, S_TRAILER, S_DONE, S_ERROR
+  };
+
+  enum StepResult : uint8_t { STEP_OK, STEP_MORE, STEP_STOP };
+
+  StepResult _step();
+  StepResult _fail() { _state = S_ERROR; return STEP_STOP; }
+  bool       _have(uint8_t n) const { return _nbits >= n; }
+  uint32_t   _take(uint8_t n);
+  int        _decode(const Tree& t);   // -1 need more bits, -2 invalid code
+  bool       _build(Tree& t, const uint8_t* lengths, uint16_t num);
+  void       _buildFixed();
+  bool       _copy(uint16_t len, uint16_t dist);
+  void       _put(uint8_t b);
+  void       _flush();
+
+  Format    _format     = FORMAT_GZIP;
+  State     _state      = S_GZ_HEADER;
+  Sink      _sink       = nullptr;
+  void*     _ctx        = nullptr;
+
+  // Input bit buffer (LSB first)
+  uint32_t  _bits       = 0;
+  uint8_t   _nbits      = 0;
+
+  // History window (ring buffer)
+  uint8_t*  _window     = nullptr;
+  size_t    _windowSize = 0;
+  uint32_t  _pos        = 0;      // total bytes produced
+  uint32_t  _flushed    = 0;      // bytes already passed to the sink
+
+  // Block / header bookkeeping
+  bool      _final      = false;
+  uint8_t   _flags      = 0;      // gzip FLG
+  uint16_t  _count      = 0;      // generic byte / item counter
+  uint16_t  _remaining  = 0;      // stored bytes, FEXTRA bytes, repeat count
+  uint16_t  _sym        = 0;      // pending length / code-length symbol
+  uint16_t  _len        = 0;      // pending match length
+  uint16_t  _hlit       = 0;
+  uint16_t  _hdist      = 0;
+  uint8_t   _hclen      = 0;
+
+  // Checksums over the decoded output
+  uint32_t  _crc        = 0xFFFFFFFFUL;  // gzip CRC-32
+  uint32_t  _adlerA     = 1;             // zlib Adler-32
+  uint32_t  _adlerB     = 0;
+  bool      _zlib       = false;
+  uint8_t   _trailer[8];
+
+  Tree      _lit;
+  Tree      _dist;
+  uint8_t   _lengths[288 + 32];
+};
+
+#endif // ASYNC_HTTP_INFLATE_H
@@ -0,0 +1,198 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#include "AsyncHTTPMultipart.h"
+
+// ===========================================================================
+// Building the form
+// ===========================================================================
+
+AsyncHTTPMultipart::AsyncHTTPMultipart() {
+  snprintf(_boundary, sizeof(_boundary), "AsyncHTTP%08lx%08lx",
+           (unsigned long)random(0x7FFFFFFFL), (unsigned long)micros());
+}
+
+bool AsyncHTTPMultipart::addField(const String& name, const String& value) {
+  if (!_add(name, "", "", PART_TEXT, value.length())) return false;
+  _parts[_count - 1].text = value;
+  return true;
+}
+
+bool AsyncHTTPMultipart::addField(const String& name,
+                                  const __FlashStringHelper* value) {
+  const char* p = reinterpret_cast<const char*>(value);
+  if (!_add(name, "", "", PART_FLASH, strlen_P(p))) return false;
+  _parts[_count - 1].data = reinterpret_cast<const uint8_t*>(p);
+  return true;
+}
+
+bool AsyncHTTPMultipart::addData(const String& name, const String& filename,
+                                 const uint8_t* data, size_t len,
+                                 const String& contentType) {
+  if (!_add(name, filename, contentType, PART_RAM, len)) return false;
+  _parts[_count - 1].data = data;
+  return true;
+}
+
+bool AsyncHTTPMultipart::addData(const String& name, const String& filename,
+                                 const __FlashStringHelper* data, size_t len,
+                                 const String& contentType) {
+  if (!_add(name, filename, contentType, PART_FLASH, len)) return false;
+  _parts[_count - 1].data = reinterpret_cast<const uint8_t*>(data);
+  return true;
+}
+
+bool AsyncHTTPMultipart::addStream(const String& name, const String& filename,
+                                   Stream& stream, long len,
+                                   const String& contentType) {
+  if (len < 0 || !_add(name, filename, contentType, PART_STREAM, len)) {
+    return false;
+  }
+  _parts[_count - 1].stream = &stream;
+  return true;
+}
+
+void AsyncHTTPMultipart::clear() {
+  for (uint8_t i = 0; i < _count; i++) _parts[i] = Part();
+  _count = 0;
+  start();
+}
+
+// Part headers are built once; quotes and line breaks in names would break
+// the framing, so they are replaced
+bool AsyncHTTPMultipart::_add(const String& name, const String& filename,
+                              const String& contentType, Kind kind, long len) {
+  if (_count >= ASYNC_HTTP_MULTIPART_PARTS) return false;
+
+  String n = name;
+  String f = filename;
+  n.replace("\"", "%22");  n.replace("\r", " ");  n.replace("\n", " ");
+  f.replace("\"", "%22");  f.replace("\r", " ");  f.replace("\n", " ");
+
+  Part& p = _parts[_count++];
+  p.kind = kind;
+  p.len  = len;
+  p.head  = F("--");
+  p.head += _boundary;
+  p.head += F("\r\nContent-Disposition: form-data; name=\"");
+  p.head += n;
+  p.head += '"';
+  if (kind != PART_TEXT && f.length() > 0) {
+    p.head += F("; filename=\"");
+    p.head += f;
+    p.head += '"';
+  }
+  if (contentType.length() > 0) {
+    p.head += F("\r\nContent-Type: ");
+    p.head += contentType;
+  }
+  p.head += F("\r\n\r\n");
+  return true;
+}
+
+String AsyncHTTPMultipart::contentType() const {
+  String ct = F("multipart/form-data; boundary=");
+  ct += _boundary;
+  return ct;
+}
+
+// Every part: head + data + CRLF; then "--boundary--" CRLF
+long AsyncHTTPMultipart::contentLength() const {
+  long total = 2 + strlen(_boundary) + 4;
+  for (uint8_t i = 0; i < _count; i++) {
+    total += _parts[i].head.length() + _parts[i].len + 2;
+  }
+  return total;
+}
+
+// ===========================================================================
+// Producing the body
+// ===========================================================================
+
+void AsyncHTTPMultipart::start() {
+  _consumed = false;
+  rewind();
+}
+
+bool AsyncHTTPMultipart::rewind() {
+  _part    = 0;
+  _section = 0;
+  _pos     = 0;
+  return !_consumed;
+}
+
+size_t AsyncHTTPMultipart::_copy(const String& s, uint8_t* buf, size_t max) {
+  size_t n = s.length() - _pos;
+  if (n > max) n = max;
+  memcpy(buf, s.c_str() + _pos, n);
+  _pos += n;
+  return n;
+}
+
+size_t AsyncHTTPMultipart::read(uint8_t* buf, size_t max) {
+  size_t out = 0;
+  while (out < max && !done()) {
+    // Closing delimiter
+    if (_part == _count) {
+      String close = F("--");
+      close += _boundary;
+      close += F("--\r\n");
+      out += _copy(close, buf + out, max - out);
+      if (_pos == (long)close.length()) _part++;
+      continue;
+    }
+
+    Part&  p    = _parts[_part];
+    size_t room = max - out;
+    if (_section == 0) {
+      out += _copy(p.head, buf + out, room);
+      if (_pos == (long)p.head.length()) { _section = 1; _pos = 0; }
+      continue;
+    }
+    if (_section == 2) {
+      static const char crlf[] = "\r\n";
+      size_t n = 2 - _pos;
+      if (n > room) n = room;
+      memcpy(buf + out, crlf + _pos, n);
+      out  += n;
+      _pos += n;
+      if (_pos == 2) { _part++; _section = 0; _pos = 0; }
+      continue;
+    }
+
+    // Part data
+    if (_pos >= p.len) {
+      _section = 2;
+      _pos     = 0;
+      continue;
+    }
+    size_t n = 0;
+    if (p.kind == PART_STREAM) {
+      _consumed = true;
+      int avail = p.stream->available();
+      if (avail <= 0) return out;       // more is promised – try later
+      n = (size_t)avail < room ? (size_t)avail : room;
+      if ((long)n > p.len - _pos) n = p.len - _pos;
+      n = p.stream->readBytes(reinterpret_cast<char*>(buf + out), n);
+      if (n == 0) return out;
+    } else {
+      n = p.len - _pos;
+      if (n > room) n = room;
+      if (p.kind == PART_TEXT) {
+        memcpy(buf + out, p.text.c_str() + _pos, n);
+      } else if (p.kind == PART_FLASH) {
+        memcpy_P(buf + out, p.data + _pos, n);
+      } else {
+        memcpy(buf + out, p.data + _pos, n);
+      }
+    }
+    out  += n;
+    _pos += n;
+  }
+  return out;
+}
@@ -0,0 +1,100 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#ifndef ASYNC_HTTP_MULTIPART_H
+#define ASYNC_HTTP_MULTIPART_H
+
+#include <Arduino.h>
+
+#ifndef ASYNC_HTTP_MULTIPART_PARTS
+  #define ASYNC_HTTP_MULTIPART_PARTS 8        // parts per AsyncHTTPMultipart
+#endif
+
+// ---------------------------------------------------------------------------
+// AsyncHTTPMultipart – multipart/form-data body for AsyncHTTP::postMultipart
+//
+// Parts refer to the caller's data (RAM buffers, flash strings, Streams)
+// instead of copying it; only the small per-part headers are kept. The body
+// is produced piece by piece with read() while the request is being sent,
+// and goes out with a Content-Length computed up front.
+// ---------------------------------------------------------------------------
+class AsyncHTTPMultipart {
+public:
+  AsyncHTTPMultipart();
+
+  /// Text field; the value is copied
+  bool addField(const String& name, const String& value);
+
+  /// Text field from a flash string (not copied)
+  bool addField(const String& name, const __FlashStringHelper* value);
+
+  /// File part from a RAM buffer (not copied, must outlive the request)
+  bool addData(const String& name, const String& filename,
+               const uint8_t* data, size_t len,
+               const String& contentType = "application/octet-stream");
+
+  /// File part from flash (PROGMEM, not copied)
+  bool addData(const String& name, const String& filename,
+               const __FlashStringHelper* data, size_t len,
+               const String& contentType = "application/octet-stream");
+
+  /// File part read from a Stream (e.g. an open fs::File) while sending.
+  /// Exactly `len` bytes are sent, however long the stream takes to supply
+  /// them; a negative `len` is refused.
+  bool addStream(const String& name, const String& filename, Stream& stream,
+                 long len,
+                 const String& contentType = "application/octet-stream");
+
+  /// Remove all parts
+  void clear();
+
+  /// "multipart/form-data; boundary=..."
+  String contentType() const;
+
+  /// Total body size
+  long contentLength() const;
+
+  // ---- Used by AsyncHTTP while the request is sent ----
+
+  /// New request: start at the first part with every Stream part unread
+  void   start();
+  /// Start over at the first part. Returns false once a Stream part has
+  /// been read, since a Stream cannot be read twice.
+  bool   rewind();
+  /// Next body bytes, at most `max`. 0 with !done() = Stream not ready yet.
+  size_t read(uint8_t* buf, size_t max);
+  bool   done() const { return _part > _count; }
+
+private:
+  enum Kind : uint8_t { PART_TEXT, PART_RAM, PART_FLASH, PART_STREAM };
+
+  struct Part {
+    String          head;             // delimiter + part headers
+    String          text;             // PART_TEXT value
+    const uint8_t*  data   = nullptr; // PART_RAM / PART_FLASH
+    Stream*         stream = nullptr; // PART_STREAM
+    long            len    = 0;
+    Kind            kind   = PART_TEXT;
+  };
+
+  bool   _add(const String& name, const String& filename,
+              const String& contentType, Kind kind, long len);
+  size_t _copy(const String& s, uint8_t* buf, size_t max);
+
+  char    _boundary[32];
+  Part    _parts[ASYNC_HTTP_MULTIPART_PARTS];
+  uint8_t _count    = 0;
+
+  // Read cursor: part (_count = closing delimiter), section and position
+  uint8_t _part     = 0;
+  uint8_t _section  = 0;              // 0 = head, 1 = data, 2 = CRLF
+  long    _pos      = 0;
+  bool    _consumed = false;          // a Stream part was read since start()
+};
+
+#endif // ASYNC_HTTP_MULTIPART_H
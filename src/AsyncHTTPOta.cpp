@@ -0,0 +1,260 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#include "AsyncHTTPOta.h"
+
+#if ASYNC_HTTP_OTA
+
+static int _hexNibble(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// ===========================================================================
+// Setup / teardown
+// ===========================================================================
+
+AsyncHTTPOta::~AsyncHTTPOta() {
+  abort();
+}
+
+int AsyncHTTPOta::begin(AsyncHTTP& http, const String& url,
+                        const char* sha256, DoneCallback onDone,
+                        void* userData) {
+  abort();                              // one update at a time
+  mbedtls_sha256_init(&_sha);
+
+  _verify = sha256 != nullptr;
+  if (_verify) {
+    if (strlen(sha256) != 64) return ASYNC_HTTP_ERR_OTA_CHECKSUM;
+    for (uint8_t i = 0; i < 32; i++) {
+      int hi = _hexNibble(sha256[2 * i]);
+      int lo = _hexNibble(sha256[2 * i + 1]);
+      if (hi < 0 || lo < 0) return ASYNC_HTTP_ERR_OTA_CHECKSUM;
+      _expected[i] = (uint8_t)(hi << 4 | lo);
+    }
+  }
+
+  _buf[0] = (uint8_t*)malloc(ASYNC_HTTP_OTA_BUFFER);
+  _buf[1] = (uint8_t*)malloc(ASYNC_HTTP_OTA_BUFFER);
+  if (!_buf[0] || !_buf[1]) {
+    _release();
+    return ASYNC_HTTP_ERR_NO_MEMORY;
+  }
+  if (!Update.begin(UPDATE_SIZE_UNKNOWN)) {
+    _release();
+    return ASYNC_HTTP_ERR_OTA_WRITE;
+  }
+
+  // Flash writes run in their own task; without one they happen inline
+  _blocks = xQueueCreate(2, sizeof(Block));
+  _free   = xSemaphoreCreateCounting(2, 2);
+  if (!_blocks || !_free ||
+      xTaskCreate(_writerTask, "ota-write", 4096, this,
+                  uxTaskPriorityGet(nullptr), &_task) != pdPASS) {
+    _task = nullptr;
+  }
+
+  mbedtls_sha256_starts(&_sha, 0);
+  _fill        = -1;
+  _next        = 0;
+  _fillLen     = 0;
+  _writeFailed = false;
+  _received    = 0;
+  _total       = -1;
+  _startedAt   = millis();
+  _doneCb      = onDone;
+  _doneData    = userData;
+
+  _id = http.download(url, _onData, _onResponse, this);
+  if (_id < 0) {
+    _release();
+    Update.abort();
+    return _id;
+  }
+  http.onError(_id, _onError, this);
+  _http = &http;
+  return _id;
+}
+
+void AsyncHTTPOta::onProgress(ProgressCallback cb, void* userData) {
+  _progressCb   = cb;
+  _progressData = userData;
+}
+
+void AsyncHTTPOta::abort() {
+  if (!_http) return;
+  _http->abort(_id);
+  _http = nullptr;
+  _id   = -1;
+  _release();
+  Update.abort();
+}
+
+uint32_t AsyncHTTPOta::bytesPerSecond() const {
+  unsigned long elapsed = millis() - _startedAt;
+  return elapsed ? (uint32_t)((uint64_t)_received * 1000 / elapsed) : 0;
+}
+
+// Wait for the writer, then free the task, buffers and hash state
+void AsyncHTTPOta::_release() {
+  if (_task) {
+    _drain();
+    vTaskDelete(_task);
+    _task = nullptr;
+  }
+  if (_blocks) vQueueDelete(_blocks);
+  if (_free) vSemaphoreDelete(_free);
+  _blocks = nullptr;
+  _free   = nullptr;
+  free(_buf[0]);
+  free(_buf[1]);
+  _buf[0] = _buf[1] = nullptr;
+  _fill   = -1;
+  mbedtls_sha256_free(&_sha);
+}
+
+// ===========================================================================
+// Receive path (AsyncHTTP callbacks, loop task)
+// ===========================================================================
+
+void AsyncHTTPOta::_onData(const uint8_t* data, size_t len, uint32_t offset,
+                           void* userData) {
+  AsyncHTTPOta* self = static_cast<AsyncHTTPOta*>(userData);
+  if (self->_total < 0) self->_total = self->_http->downloadSize(self->_id);
+
+  // Flash is written in order; a resume that does not continue exactly
+  // where the image stopped would corrupt it
+  if (offset != self->_received) {
+    self->_http->abort(self->_id);
+    self->_finish(ASYNC_HTTP_ERR_INCOMPLETE, F("Download not contiguous"));
+    return;
+  }
+
+  mbedtls_sha256_update(&self->_sha, data, len);
+  self->_received += len;
+  self->_push(data, len);
+
+  if (self->_writeFailed) {
+    self->_http->abort(self->_id);      // no point fetching the rest
+    self->_finish(ASYNC_HTTP_ERR_OTA_WRITE, Update.errorString());
+  }
+}
+
+void AsyncHTTPOta::_onResponse(const AsyncHTTPResponse& response,
+                               void* userData) {
+  AsyncHTTPOta* self = static_cast<AsyncHTTPOta*>(userData);
+  if (!response.isSuccess()) {
+    self->_finish(response.statusCode(), F("Download failed"));
+    return;
+  }
+
+  if (self->_fill >= 0) self->_submit();
+  if (!self->_drain()) {
+    self->_finish(ASYNC_HTTP_ERR_OTA_WRITE, Update.errorString());
+    return;
+  }
+  if (self->_verify) {
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&self->_sha, digest);
+    if (memcmp(digest, self->_expected, sizeof(digest)) != 0) {
+      self->_finish(ASYNC_HTTP_ERR_OTA_CHECKSUM, F("SHA-256 mismatch"));
+      return;
+    }
+  }
+  if (!Update.end(true)) {
+    self->_finish(ASYNC_HTTP_ERR_OTA_WRITE, Update.errorString());
+    return;
+  }
+  self->_total = self->_received;
+  self->_progress();
+  self->_finish(0, String());
+}
+
+void AsyncHTTPOta::_onError(int code, const String& message, void* userData) {
+  static_cast<AsyncHTTPOta*>(userData)->_finish(code, message);
+}
+
+void AsyncHTTPOta::_finish(int error, const String& message) {
+  _http = nullptr;
+  _id   = -1;
+  _release();
+  if (error != 0) Update.abort();
+  if (_doneCb) _doneCb(error, message, _doneData);
+}
+
+void AsyncHTTPOta::_progress() {
+  if (_progressCb) {
+    _progressCb(_received, _total, bytesPerSecond(), _progressData);
+  }
+}
+
+// ===========================================================================
+// Double buffer
+// ===========================================================================
+
+// Copy into the buffer being filled; a free buffer is waited for only if
+// the writer still has both
+void AsyncHTTPOta::_push(const uint8_t* data, size_t len) {
+  while (len > 0) {
+    if (_fill < 0) {
+      if (_task) xSemaphoreTake(_free, portMAX_DELAY);
+      _fill    = (int8_t)_next;
+      _next   ^= 1;
+      _fillLen = 0;
+    }
+    size_t n = ASYNC_HTTP_OTA_BUFFER - _fillLen;
+    if (n > len) n = len;
+    memcpy(_buf[_fill] + _fillLen, data, n);
+    _fillLen += n;
+    data     += n;
+    len      -= n;
+    if (_fillLen == ASYNC_HTTP_OTA_BUFFER) _submit();
+  }
+}
+
+// Hand the filled buffer to the writer task (or write it right away)
+void AsyncHTTPOta::_submit() {
+  if (_task) {
+    Block b = { (uint8_t)_fill, _fillLen };
+    xQueueSend(_blocks, &b, portMAX_DELAY);
+  } else if (!_writeFailed &&
+             Update.write(_buf[_fill], _fillLen) != _fillLen) {
+    _writeFailed = true;
+  }
+  _fill = -1;
+  _progress();
+}
+
+// Wait until every submitted buffer is in flash. Returns false if a write
+// failed.
+bool AsyncHTTPOta::_drain() {
+  if (_task) {
+    uint8_t held = (_fill >= 0) ? 1 : 0;
+    for (uint8_t i = held; i < 2; i++) xSemaphoreTake(_free, portMAX_DELAY);
+    for (uint8_t i = held; i < 2; i++) xSemaphoreGive(_free);
+  }
+  return !_writeFailed;
+}
+
+void AsyncHTTPOta::_writerTask(void* arg) {
+  AsyncHTTPOta* self = static_cast<AsyncHTTPOta*>(arg);
+  Block b;
+  for (;;) {
+    if (xQueueReceive(self->_blocks, &b, portMAX_DELAY) != pdTRUE) continue;
+    if (!self->_writeFailed &&
+        Update.write(self->_buf[b.index], b.len) != b.len) {
+      self->_writeFailed = true;
+    }
+    xSemaphoreGive(self->_free);
+  }
+}
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#ifndef ASYNC_HTTP_OTA_H
+#define ASYNC_HTTP_OTA_H
+
+#include "AsyncHTTP.h"
+
+#if defined(ESP32)
+  #include <Update.h>
+  #include <mbedtls/sha256.h>
+  #include <freertos/FreeRTOS.h>
+  #include <freertos/task.h>
+  #include <freertos/queue.h>
+  #include <freertos/semphr.h>
+  #define ASYNC_HTTP_OTA 1
+#else
+  #define ASYNC_HTTP_OTA 0
+#endif
+
+#ifndef ASYNC_HTTP_OTA_BUFFER
+  #define ASYNC_HTTP_OTA_BUFFER      4096     // bytes per flash write (×2 buffers)
+#endif
+
+#if ASYNC_HTTP_OTA
+// ---------------------------------------------------------------------------
+// AsyncHTTPOta – streams a firmware download into the next OTA partition
+//
+// Body bytes go from AsyncHTTP::download() into one of two flash-sector
+// sized buffers; a full buffer is written by a separate FreeRTOS task while
+// the next one is filled, so the receive path only waits when flash falls
+// behind. The image is hashed (SHA-256) as it arrives and only accepted by
+// Update.end() if it matches. Dropped connections resume like any download.
+// ---------------------------------------------------------------------------
+class AsyncHTTPOta {
+public:
+  typedef void (*ProgressCallback)(uint32_t received, long total,
+                                   uint32_t bytesPerSec, void* userData);
+  /// `error`: 0 = image accepted, > 0 = HTTP status of a failed download,
+  /// < 0 = ASYNC_HTTP_ERR_* code
+  typedef void (*DoneCallback)(int error, const String& message,
+                               void* userData);
+
+  AsyncHTTPOta() {}
+  ~AsyncHTTPOta();
+
+  /// Start downloading `url` into the next OTA partition. `sha256` is the
+  /// expected digest as 64 hex characters (nullptr = no check). `onDone` is
+  /// called once; after success the new image boots on the next restart.
+  /// Returns the request id, or an ASYNC_HTTP_ERR_* code.
+  int begin(AsyncHTTP& http, const String& url, const char* sha256 = nullptr,
+            DoneCallback onDone = nullptr, void* userData = nullptr);
+
+  /// Called after every flash buffer handed to the writer, and at the end
+  void onProgress(ProgressCallback cb, void* userData = nullptr);
+
+  /// Cancel the download and discard the partially written image
+  void abort();
+
+  bool     running()        const { return _http != nullptr; }
+  uint32_t received()       const { return _received; }
+  long     total()          const { return _total; }     // -1 = unknown
+  uint32_t bytesPerSecond() const;
+
+private:
+  static void _onData(const uint8_t* data, size_t len, uint32_t offset,
+                      void* userData);
+  static void _onResponse(const AsyncHTTPResponse& response, void* userData);
+  static void _onError(int code, const String& message, void* userData);
+  static void _writerTask(void* arg);
+
+  void _push(const uint8_t* data, size_t len);
+  void _submit();
+  bool _drain();
+  void _progress();
+  void _finish(int error, const String& message);
+  void _release();
+
+  struct Block {
+    uint8_t  index;                   // buffer to write
+    uint16_t len;
+  };
+
+  AsyncHTTP*        _http     = nullptr;
+  int               _id       = -1;
+  DoneCallback      _doneCb   = nullptr;
+  void*             _doneData = nullptr;
+  ProgressCallback  _progressCb   = nullptr;
+  void*             _progressData = nullptr;
+
+  // Verification
+  mbedtls_sha256_context _sha;
+  uint8_t           _expected[32];
+  bool              _verify   = false;
+
+  // Double buffer + writer task
+  uint8_t*          _buf[2]   = { nullptr, nullptr };
+  int8_t            _fill     = -1;   // buffer being filled, -1 = none held
+  uint8_t           _next     = 0;    // buffer to fill next
+  uint16_t          _fillLen  = 0;
+  TaskHandle_t      _task     = nullptr;
+  QueueHandle_t     _blocks   = nullptr;   // loop → writer
+  SemaphoreHandle_t _free     = nullptr;   // buffers not queued / in flight
+  volatile bool     _writeFailed = false;
+
+  // Progress
+  uint32_t          _received = 0;
+  long              _total    = -1;
+  unsigned long     _startedAt = 0;
+};
+#endif
+
+#endif // ASYNC_HTTP_OTA_H
@@ -0,0 +1,357 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#include "AsyncHTTPWebSocket.h"
+
+enum {
+  WS_OP_CONTINUATION = 0x0,
+  WS_OP_TEXT         = 0x1,
+  WS_OP_BINARY       = 0x2,
+  WS_OP_CLOSE        = 0x8,
+  WS_OP_PING         = 0x9,
+  WS_OP_PONG         = 0xA
+};
+
+// ===========================================================================
+// Handshake helpers: base64 and SHA-1 (only for Sec-WebSocket-Accept)
+// ===========================================================================
+
+static void _base64(const uint8_t* in, size_t len, char* out) {
+  static const char table[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t o = 0;
+  for (size_t i = 0; i < len; i += 3) {
+    uint32_t v = (uint32_t)in[i] << 16;
+    if (i + 1 < len) v |= (uint32_t)in[i + 1] << 8;
+    if (i + 2 < len) v |= in[i + 2];
+    out[o++] = table[(v >> 18) & 0x3F];
+    out[o++] = table[(v >> 12) & 0x3F];
+    out[o++] = (i + 1 < len) ? table[(v >> 6) & 0x3F] : '=';
+    out[o++] = (i + 2 < len) ? table[v & 0x3F] : '=';
+  }
+  out[o] = '\0';
+}
+
+static uint32_t _rol(uint32_t v, uint8_t n) {
+  return (v << n) | (v >> (32 - n));
+}
+
+static void _sha1Block(uint32_t h[5], const uint8_t* p) {
+  uint32_t w[80];
+  for (uint8_t i = 0; i < 16; i++) {
+    w[i] = (uint32_t)p[4 * i] << 24 | (uint32_t)p[4 * i + 1] << 16 |
+           (uint32_t)p[4 * i + 2] << 8 | p[4 * i + 3];
+  }
+  for (uint8_t i = 16; i < 80; i++) {
+    w[i] = _rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+  }
+  uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+  for (uint8_t i = 0; i < 80; i++) {
+    uint32_t f, k;
+    if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+    else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+    else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+    else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+    uint32_t t = _rol(a, 5) + f + e + k + w[i];
+    e = d;  d = c;  c = _rol(b, 30);  b = a;  a = t;
+  }
+  h[0] += a;  h[1] += b;  h[2] += c;  h[3] += d;  h[4] += e;
+}
+
+static void _sha1(const uint8_t* data, size_t len, uint8_t out[20]) {
+  uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476,
+                    0xC3D2E1F0 };
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64) _sha1Block(h, data + i);
+
+  // Last block(s): remaining bytes, 0x80, zeros, bit length
+  uint8_t block[64];
+  size_t  rest = len - i;
+  memcpy(block, data + i, rest);
+  block[rest++] = 0x80;
+  if (rest > 56) {
+    memset(block + rest, 0, 64 - rest);
+    _sha1Block(h, block);
+    rest = 0;
+  }
+  memset(block + rest, 0, 56 - rest);
+  uint64_t bits = (uint64_t)len * 8;
+  for (uint8_t j = 0; j < 8; j++) block[63 - j] = (uint8_t)(bits >> (8 * j));
+  _sha1Block(h, block);
+
+  for (uint8_t j = 0; j < 20; j++) out[j] = (uint8_t)(h[j / 4] >> (24 - 8 * (j % 4)));
+}
+
+// ===========================================================================
+// Public API
+// ===========================================================================
+
+AsyncHTTPWebSocket::~AsyncHTTPWebSocket() {
+  if (_http) _http->abort(_id);
+}
+
+void AsyncHTTPWebSocket::onOpen(OpenCallback cb, void* userData) {
+  _openCb   = cb;
+  _openData = userData;
+}
+
+void AsyncHTTPWebSocket::onMessage(MessageCallback cb, void* userData) {
+  _messageCb   = cb;
+  _messageData = userData;
+}
+
+void AsyncHTTPWebSocket::onClose(CloseCallback cb, void* userData) {
+  _closeCb   = cb;
+  _closeData = userData;
+}
+
+bool AsyncHTTPWebSocket::send(const char* text) {
+  if (_state != WS_OPEN) return false;
+  return _sendFrame(WS_OP_TEXT, (const uint8_t*)text, strlen(text));
+}
+
+bool AsyncHTTPWebSocket::sendBinary(const uint8_t* data, size_t len) {
+  if (_state != WS_OPEN) return false;
+  return _sendFrame(WS_OP_BINARY, data, len);
+}
+
+bool AsyncHTTPWebSocket::ping() {
+  if (_state != WS_OPEN) return false;
+  return _sendFrame(WS_OP_PING, nullptr, 0);
+}
+
+void AsyncHTTPWebSocket::close(uint16_t code, const char* reason) {
+  if (_state != WS_OPEN) return;
+  uint8_t payload[125];
+  size_t  len = strlen(reason);
+  if (len > sizeof(payload) - 2) len = sizeof(payload) - 2;
+  payload[0] = (uint8_t)(code >> 8);
+  payload[1] = (uint8_t)code;
+  memcpy(payload + 2, reason, len);
+  _sendFrame(WS_OP_CLOSE, payload, len + 2);
+  _state   = WS_CLOSING;
+  _closeAt = millis();
+}
+
+// Client frames are always masked (RFC 6455 §5.3); the payload is masked
+// into a small buffer piece by piece instead of copying it whole
+bool AsyncHTTPWebSocket::_sendFrame(uint8_t opcode, const uint8_t* data,
+                                    size_t len) {
+  if (!_client || _failed) return false;
+
+  uint8_t head[14];
+  size_t  n = 0;
+  head[n++] = 0x80 | opcode;            // FIN – messages are never fragmented
+  if (len < 126) {
+    head[n++] = 0x80 | (uint8_t)len;
+  } else if (len <= 0xFFFF) {
+    head[n++] = 0x80 | 126;
+    head[n++] = (uint8_t)(len >> 8);
+    head[n++] = (uint8_t)len;
+  } else {
+    head[n++] = 0x80 | 127;
+    for (int8_t i = 7; i >= 0; i--) {
+      head[n++] = (i < 4) ? (uint8_t)((uint32_t)len >> (8 * i)) : 0;
+    }
+  }
+  uint8_t* mask = head + n;
+  for (uint8_t i = 0; i < 4; i++) mask[i] = (uint8_t)random(256);
+  n += 4;
+  if (_client->write(head, n) != n) {
+    _failed = true;
+    return false;
+  }
+
+  uint8_t buf[64];
+  for (size_t off = 0; off < len; ) {
+    size_t k = len - off < sizeof(buf) ? len - off : sizeof(buf);
+    for (size_t i = 0; i < k; i++) buf[i] = data[off + i] ^ mask[(off + i) & 3];
+    if (_client->write(buf, k) != k) {
+      _failed = true;
+      return false;
+    }
+    off += k;
+  }
+  return true;
+}
+
+// ===========================================================================
+// Connection lifecycle (driven by AsyncHTTP)
+// ===========================================================================
+
+void AsyncHTTPWebSocket::_begin(AsyncHTTP* http, int id) {
+  _http      = http;
+  _id        = id;
+  _client    = nullptr;
+  _state     = WS_CONNECTING;
+  _failed    = false;
+  _closeCode = 1006;
+  _reason    = "";
+}
+
+// A fresh key for every handshake attempt
+const char* AsyncHTTPWebSocket::_newKey() {
+  uint8_t nonce[16];
+  for (uint8_t i = 0; i < sizeof(nonce); i++) nonce[i] = (uint8_t)random(256);
+  _base64(nonce, sizeof(nonce), _key);
+  return _key;
+}
+
+// Sec-WebSocket-Accept = base64(SHA-1(key + GUID))
+bool AsyncHTTPWebSocket::_accepts(const String& accept) const {
+  static const char guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+  uint8_t input[24 + sizeof(guid) - 1];
+  memcpy(input, _key, 24);
+  memcpy(input + 24, guid, sizeof(guid) - 1);
+  uint8_t digest[20];
+  char    expected[29];
+  _sha1(input, sizeof(input), digest);
+  _base64(digest, sizeof(digest), expected);
+  return accept == expected;
+}
+
+void AsyncHTTPWebSocket::_open(Client* client) {
+  _client    = client;
+  _state     = WS_OPEN;
+  _rx        = RX_HEAD;
+  _msgOpcode = 0;
+  _msgLen    = 0;
+  _lastRx    = millis();
+  _pingSent  = false;
+  if (_openCb) _openCb(*this, _openData);
+}
+
+// The slot is gone (finished or aborted) – nothing may be written any more
+void AsyncHTTPWebSocket::_release() {
+  _http   = nullptr;
+  _id     = -1;
+  _client = nullptr;
+  _state  = WS_CLOSED;
+}
+
+// `reason` may point into _ctrl, which is left alone until the next frame
+void AsyncHTTPWebSocket::_closed(uint16_t code, const char* reason) {
+  _release();
+  if (_closeCb) _closeCb(*this, code, reason, _closeData);
+}
+
+// ===========================================================================
+// Frame parser
+// ===========================================================================
+
+bool AsyncHTTPWebSocket::_receive(uint8_t b) {
+  _lastRx   = millis();
+  _pingSent = false;
+
+  switch (_rx) {
+    case RX_HEAD: {
+      _fin    = (b & 0x80) != 0;
+      _opcode = b & 0x0F;
+      if (b & 0x70) return _fail(1002, "Reserved bits set");
+      if (_opcode & 0x08) {
+        if (!_fin || _opcode > WS_OP_PONG) {
+          return _fail(1002, "Invalid control frame");
+        }
+      } else if (_opcode == WS_OP_CONTINUATION) {
+        if (_msgOpcode == 0) return _fail(1002, "Unexpected continuation");
+      } else if (_opcode == WS_OP_TEXT || _opcode == WS_OP_BINARY) {
+        if (_msgOpcode != 0) return _fail(1002, "Unfinished message");
+        _msgOpcode = _opcode;
+        _msgLen    = 0;
+      } else {
+        return _fail(1002, "Unknown opcode");
+      }
+      _rx = RX_LEN;
+      return false;
+    }
+
+    case RX_LEN:
+      if (b & 0x80) return _fail(1002, "Masked server frame");
+      b &= 0x7F;
+      if (b >= 126) {
+        _extLen    = (b == 126) ? 2 : 8;
+        _remaining = 0;
+        _rx        = RX_EXTLEN;
+        return false;
+      }
+      _remaining = b;
+      return _startPayload();
+
+    case RX_EXTLEN:
+      // Lengths beyond 32 bits saturate – far too big for the buffer anyway
+      _remaining = (_remaining > 0x00FFFFFFUL) ? 0xFFFFFFFFUL
+                                               : (_remaining << 8 | b);
+      if (--_extLen > 0) return false;
+      return _startPayload();
+
+    case RX_PAYLOAD:
+      if (_opcode & 0x08) {
+        _ctrl[_ctrlLen++] = b;
+      } else {
+        _msg[_msgLen++] = b;
+      }
+      if (--_remaining > 0) return false;
+      return _endFrame();
+  }
+  return false;
+}
+
+bool AsyncHTTPWebSocket::_startPayload() {
+  if (_opcode & 0x08) {
+    if (_remaining > 125) return _fail(1002, "Control frame too long");
+    _ctrlLen = 0;
+  } else if (_remaining > ASYNC_HTTP_WS_MESSAGE_SIZE - _msgLen) {
+    return _fail(1009, "Message too big");
+  }
+  if (_remaining == 0) return _endFrame();
+  _rx = RX_PAYLOAD;
+  return false;
+}
+
+bool AsyncHTTPWebSocket::_endFrame() {
+  _rx = RX_HEAD;
+  switch (_opcode) {
+    case WS_OP_CLOSE:
+      // Echo the status code, then the connection is done
+      _closeCode = (_ctrlLen >= 2) ? (uint16_t)(_ctrl[0] << 8 | _ctrl[1]) : 1005;
+      _ctrl[_ctrlLen] = '\0';
+      _reason = (_ctrlLen > 2) ? (const char*)_ctrl + 2 : "";
+      if (_state == WS_OPEN) {
+        _sendFrame(WS_OP_CLOSE, _ctrl, _ctrlLen >= 2 ? 2 : 0);
+      }
+      return true;
+
+    case WS_OP_PING:
+      if (_state == WS_OPEN) _sendFrame(WS_OP_PONG, _ctrl, _ctrlLen);
+      return false;
+
+    case WS_OP_PONG:
+      return false;
+
+    default:
+      if (!_fin) return false;          // more fragments follow
+      bool binary = _msgOpcode == WS_OP_BINARY;
+      _msgOpcode = 0;
+      _msg[_msgLen] = '\0';
+      if (_state == WS_OPEN && _messageCb) {
+        _messageCb(*this, _msg, _msgLen, binary, _messageData);
+      }
+      return false;
+  }
+}
+
+// Protocol violation: tell the server why, then drop the connection
+bool AsyncHTTPWebSocket::_fail(uint16_t code, const char* reason) {
+  if (_state == WS_OPEN) {
+    uint8_t payload[2] = { (uint8_t)(code >> 8), (uint8_t)code };
+    _sendFrame(WS_OP_CLOSE, payload, sizeof(payload));
+  }
+  _closeCode = code;
+  _reason    = reason;
+  return true;
+}
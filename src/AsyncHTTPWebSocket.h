@@ -0,0 +1,114 @@
+/*
+ * AsyncHTTP - Non-blocking async HTTP client for Arduino
+ * Compatible with Arduino UNO R4 WiFi and ESP32 series
+ *
+ * Copyright (c) 2026 Aily Project
+ * Licensed under the MIT License
+ */
+
+#ifndef ASYNC_HTTP_WEBSOCKET_H
+#define ASYNC_HTTP_WEBSOCKET_H
+
+#include "AsyncHTTP.h"
+
+#ifndef ASYNC_HTTP_WS_MESSAGE_SIZE
+  #define ASYNC_HTTP_WS_MESSAGE_SIZE 1024     // largest message received (bigger: close 1009)
+#endif
+
+// ---------------------------------------------------------------------------
+// AsyncHTTPWebSocket – WebSocket client connection (RFC 6455)
+//
+// AsyncHTTP::websocket() sends the Upgrade handshake through the normal
+// connect / send / header states, so the socket comes from the shared
+// connection pool (TLS included). After the 101 response the slot stays in
+// STATE_WEBSOCKET and update() feeds the received bytes to the frame parser
+// here. Fragmented messages are joined in a fixed buffer; pings are
+// answered, and a silent connection is pinged every
+// ASYNC_HTTP_WS_PING_INTERVAL. Outgoing frames are masked in small pieces
+// straight to the socket. The object must outlive the connection.
+// ---------------------------------------------------------------------------
+class AsyncHTTPWebSocket {
+public:
+  typedef void (*OpenCallback)(AsyncHTTPWebSocket& ws, void* userData);
+  /// Complete message; text messages are also NUL-terminated
+  typedef void (*MessageCallback)(AsyncHTTPWebSocket& ws, const uint8_t* data,
+                                  size_t len, bool binary, void* userData);
+  /// `code` 1006 = connection lost or never opened (no close frame)
+  typedef void (*CloseCallback)(AsyncHTTPWebSocket& ws, uint16_t code,
+                                const char* reason, void* userData);
+
+  AsyncHTTPWebSocket() {}
+  ~AsyncHTTPWebSocket();
+
+  void onOpen(OpenCallback cb, void* userData = nullptr);
+  void onMessage(MessageCallback cb, void* userData = nullptr);
+  void onClose(CloseCallback cb, void* userData = nullptr);
+
+  /// Send a text / binary message. False if not open or the write failed.
+  bool send(const char* text);
+  bool send(const String& text) { return send(text.c_str()); }
+  bool sendBinary(const uint8_t* data, size_t len);
+  bool ping();
+
+  /// Start the closing handshake; onClose follows once the server answers
+  /// (or after the request timeout). Messages are no longer delivered.
+  void close(uint16_t code = 1000, const char* reason = "");
+
+  bool isOpen() const { return _state == WS_OPEN; }
+
+private:
+  friend class AsyncHTTP;
+  friend struct AsyncHTTPRequest;
+
+  enum State : uint8_t { WS_CLOSED, WS_CONNECTING, WS_OPEN, WS_CLOSING };
+  enum Rx : uint8_t { RX_HEAD, RX_LEN, RX_EXTLEN, RX_PAYLOAD };
+
+  // ---- Used by AsyncHTTP ----
+  void        _begin(AsyncHTTP* http, int id);
+  const char* _newKey();
+  bool        _accepts(const String& accept) const;
+  void        _open(Client* client);
+  bool        _receive(uint8_t b);      // true = connection is to be closed
+  void        _release();
+  void        _closed(uint16_t code, const char* reason);
+
+  bool _startPayload();
+  bool _endFrame();
+  bool _fail(uint16_t code, const char* reason);
+  bool _sendFrame(uint8_t opcode, const uint8_t* data, size_t len);
+
+  AsyncHTTP*      _http       = nullptr;
+  int             _id         = -1;
+  Client*         _client     = nullptr;
+  State           _state      = WS_CLOSED;
+  char            _key[25];             // Sec-WebSocket-Key (base64)
+
+  // Frame parser
+  Rx              _rx         = RX_HEAD;
+  uint8_t         _opcode     = 0;
+  bool            _fin        = false;
+  uint8_t         _extLen     = 0;      // extended length bytes still due
+  uint32_t        _remaining  = 0;      // payload bytes of the frame
+  uint8_t         _msgOpcode  = 0;      // message being assembled, 0 = none
+  uint8_t         _msg[ASYNC_HTTP_WS_MESSAGE_SIZE + 1];
+  size_t          _msgLen     = 0;
+  uint8_t         _ctrl[126];           // control frame payload
+  uint8_t         _ctrlLen    = 0;
+
+  // Liveness / closing
+  unsigned long   _lastRx     = 0;
+  bool            _pingSent   = false;
+  unsigned long   _closeAt    = 0;      // close() sent
+  bool            _failed     = false;  // a write failed
+  uint16_t        _closeCode  = 1006;
+  const char*     _reason     = "";
+
+  OpenCallback    _openCb     = nullptr;
+  void*           _openData   = nullptr;
+  MessageCallback _messageCb  = nullptr;
+  void*           _messageData = nullptr;
+  CloseCallback   _closeCb    = nullptr;
+  void*           _closeData  = nullptr;
+};
+
+#endif // ASYNC_HTTP_WEBSOCKET_H